@@ -0,0 +1,95 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Completion of the slaves waited by the master (see LibraryFreeRTOS_RP2040Barrier.h):
+// test_barrier wakes the master once per iteration, test_barrier_spin polls the barrier before
+// blocking, test_barrier_notify takes one notification per slave. After N_WARMUP iterations the
+// master prints the statistics of the round trip (from the dispatch of the input to the check of
+// the results) and the times it has been woken up per iteration over N_ROUNDS iterations.
+
+#define N_WARMUP 100
+#define N_ROUNDS 2000
+#define SLAVE_WORK 200  // Rounds of the slave loop, so that the slaves complete at about the same time.
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_barrier,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static struct run_stats round_trip;
+static uint32_t count, errors, blocks_start;
+
+static uint32_t expected(uint32_t input){
+    uint32_t state = input + 1;
+    for(int i=0; i<SLAVE_WORK; ++i){
+        state = state * 1664525u + 1013904223u;
+    }
+    return state;
+}
+
+static void vTaskMasterSetup(){
+    run_stats_init(&round_trip);
+    count = 0;
+    errors = 0;
+}
+
+static void vTaskMasterLoop(){
+    uint32_t result;
+    bool outcome;
+
+    if(count == N_WARMUP){
+        blocks_start = completion_barrier_blocks(&completion_test_barrier);
+    }
+    if(count == N_WARMUP+N_ROUNDS){
+        uint32_t wakeups = completion_barrier_blocks(&completion_test_barrier) - blocks_start;
+        bool ok = errors == 0 && round_trip.count == N_ROUNDS &&
+            wakeups <= (RP2040config_USE_COMPLETION_BARRIER ? 1 : RP2040config_testRUN_ON_CORES) * N_ROUNDS;
+        printf("test_barrier> completion:\t %s, spin %lu \n",
+            RP2040config_USE_COMPLETION_BARRIER ? "barrier" : "notify", (unsigned long) RP2040config_BARRIER_SPIN);
+        run_stats_print("test_barrier", 0, &round_trip, RP2040_TIME_UNIT);
+        printf("test_barrier> wakeups_per_iteration:\t %lu.%02lu \n", (unsigned long) (wakeups / N_ROUNDS),
+            (unsigned long) (wakeups % N_ROUNDS * 100 / N_ROUNDS));
+        printf("test_barrier> errors:\t %lu \n", (unsigned long) errors);
+        printf("test_barrier> %s\n", ok ? "PASSED" : "FAILED");
+        exit_test_pipeline(test_barrier)
+        return;
+    }
+
+    save_time_now();
+    prepare_input_for_slaves(test_barrier, count)
+    receive_output_from_slaves(test_barrier, DEFAULT_CHECK, result, outcome)
+    uint64_t elapsed = calc_time_diff();
+    if(!outcome || result != expected(count)){
+        errors++;
+    }
+    if(count >= N_WARMUP){
+        run_stats_add(&round_trip, elapsed);
+    }
+    count++;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    return expected(*((uint32_t*) param));
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_barrier);
+
+    start_FreeRTOS();
+}
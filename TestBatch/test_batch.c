@@ -0,0 +1,78 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+#define N_ITEMS 20000 // Number of inputs processed before the test ends.
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_batch,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static uint32_t count;
+static uint32_t errors;
+static uint64_t start_time;
+
+static void vTaskMasterSetup(){
+    count = 0;
+    errors = 0;
+    start_time = time_us_64();
+}
+
+// Every iteration submits RP2040config_BATCH_SIZE inputs at once to the slaves.
+static void vTaskMasterLoop(){
+    uint32_t inputs[RP2040config_BATCH_SIZE];
+    uint32_t outputs[RP2040config_BATCH_SIZE] = {0};
+    bool outcomes[RP2040config_BATCH_SIZE] = {false};
+    uint32_t failures;
+
+    if(count >= N_ITEMS){
+        uint64_t elapsed = time_us_64() - start_time;
+        printf("test_batch> batch_size:\t %d \n", RP2040config_BATCH_SIZE);
+        printf("test_batch> items:\t %lu \n", (unsigned long) count);
+        printf("test_batch> elapsed_us:\t %llu \n", (unsigned long long) elapsed);
+        printf("test_batch> items_per_s:\t %llu \n", (unsigned long long) (count*1000000ull/elapsed));
+        printf("test_batch> errors:\t %lu \n", (unsigned long) errors);
+        exit_test_pipeline(test_batch)
+        return;
+    }
+
+    for(int k=0; k<RP2040config_BATCH_SIZE; ++k){
+        inputs[k] = count + k;
+    }
+    prepare_batch_for_slaves(test_batch, inputs, RP2040config_BATCH_SIZE)
+
+    receive_batch_from_slaves(test_batch, DEFAULT_CHECK, outputs, outcomes, failures)
+    errors += failures;
+    for(int k=0; k<RP2040config_BATCH_SIZE; ++k){
+        if(outcomes[k] && outputs[k] != 3*inputs[k]){
+            errors++;
+        }
+    }
+    count += RP2040config_BATCH_SIZE;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    return 3*(*((uint32_t*) param));
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_batch);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,143 @@
+/*
+
+Host test and benchmark of the broadcast channel (LibraryFreeRTOS_RP2040Broadcast.h).
+
+One producer thread hands N_MESSAGES payloads to RP2040config_testRUN_ON_CORES reader threads, either:
+
+- broadcast : the payload is published once and read in place by every reader;
+- copy      : the payload is copied in a mailbox per reader, as prepare_input_for_slaves does.
+
+Every reader checks the content of each payload, so the run also validates that no payload is
+lost, duplicated or overwritten while being read.
+
+*/
+
+#define _GNU_SOURCE
+#include "LibraryFreeRTOS_RP2040Broadcast.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_MESSAGES 200000 // Payloads sent for each size and mode.
+#define MIN_PAYLOAD 4
+#define MAX_PAYLOAD 4096
+#define N_READERS RP2040config_testRUN_ON_CORES
+
+// Mailbox used by the copy path: the same protocol of the channel, with one reader.
+struct copy_mailbox{
+    uint32_t sequence[RP2040config_BROADCAST_SLOTS];
+    uint32_t ack[RP2040config_BROADCAST_SLOTS];
+    uint32_t payload[RP2040config_BROADCAST_SLOTS][MAX_PAYLOAD/sizeof(uint32_t)];
+};
+
+static struct broadcast_channel channel;
+static uint32_t channel_storage[RP2040config_BROADCAST_SLOTS][MAX_PAYLOAD/sizeof(uint32_t)];
+static struct copy_mailbox mailboxes[N_READERS];
+static uint32_t input[MAX_PAYLOAD/sizeof(uint32_t)];
+
+static size_t payload_words;
+static bool use_broadcast;
+static uint32_t errors[N_READERS];
+
+static double now_s(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+// Every word of the payload of message "sequence" holds the sequence itself.
+static uint32_t check_payload(const uint32_t *payload, uint32_t sequence){
+    uint32_t sum = 0;
+    for(size_t i=0; i<payload_words; ++i){
+        sum += payload[i];
+    }
+    return (payload[0] != sequence || sum != sequence*(uint32_t) payload_words) ? 1 : 0;
+}
+
+static void *reader(void *param){
+    int id = (int) (intptr_t) param;
+    for(uint32_t sequence=1; sequence<=N_MESSAGES; ++sequence){
+        if(use_broadcast){
+            const uint32_t *payload;
+            while((payload = broadcast_read(&channel, id, NULL)) == NULL){
+                sched_yield();
+            }
+            errors[id] += check_payload(payload, sequence);
+            broadcast_release(&channel, id);
+        } else {
+            struct copy_mailbox *mailbox = &mailboxes[id];
+            int slot = sequence % RP2040config_BROADCAST_SLOTS;
+            while(__atomic_load_n(&mailbox->sequence[slot], __ATOMIC_ACQUIRE) != sequence){
+                sched_yield();
+            }
+            errors[id] += check_payload(mailbox->payload[slot], sequence);
+            __atomic_store_n(&mailbox->ack[slot], sequence, __ATOMIC_RELEASE);
+        }
+    }
+    return NULL;
+}
+
+static void producer(){
+    for(uint32_t sequence=1; sequence<=N_MESSAGES; ++sequence){
+        for(size_t i=0; i<payload_words; ++i){
+            input[i] = sequence;
+        }
+        if(use_broadcast){
+            void *slot;
+            while((slot = broadcast_acquire(&channel)) == NULL){
+                sched_yield();
+            }
+            memcpy(slot, input, payload_words*sizeof(uint32_t));
+            broadcast_publish(&channel, payload_words*sizeof(uint32_t));
+        } else {
+            int slot = sequence % RP2040config_BROADCAST_SLOTS;
+            for(int r=0; r<N_READERS; ++r){
+                struct copy_mailbox *mailbox = &mailboxes[r];
+                while(__atomic_load_n(&mailbox->ack[slot], __ATOMIC_ACQUIRE) != mailbox->sequence[slot]){
+                    sched_yield();
+                }
+                memcpy(mailbox->payload[slot], input, payload_words*sizeof(uint32_t));
+                __atomic_store_n(&mailbox->sequence[slot], sequence, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+
+static double run(size_t payload_size, bool broadcast){
+    pthread_t readers[N_READERS];
+    payload_words = payload_size/sizeof(uint32_t);
+    use_broadcast = broadcast;
+    broadcast_init(&channel, channel_storage, sizeof(channel_storage[0]));
+    memset(mailboxes, 0, sizeof(mailboxes));
+    double start = now_s();
+    for(int r=0; r<N_READERS; ++r){
+        pthread_create(&readers[r], NULL, reader, (void *) (intptr_t) r);
+    }
+    producer();
+    for(int r=0; r<N_READERS; ++r){
+        pthread_join(readers[r], NULL);
+    }
+    return N_MESSAGES/(now_s() - start);
+}
+
+int main(void) {
+    uint32_t total_errors = 0;
+
+    for(size_t size=MIN_PAYLOAD; size<=MAX_PAYLOAD; size*=4){
+        double broadcast = run(size, true);
+        double copy = run(size, false);
+        printf("test_broadcast> payload_size:\t %zu \n", size);
+        printf("test_broadcast> broadcast_msg_per_s:\t %.0f \n", broadcast);
+        printf("test_broadcast> copy_msg_per_s:\t %.0f \n", copy);
+        printf("test_broadcast> speedup:\t %.2f \n\n", broadcast/copy);
+    }
+    for(int r=0; r<N_READERS; ++r){
+        total_errors += errors[r];
+    }
+    printf("test_broadcast> errors:\t %u \n", total_errors);
+    printf("test_broadcast> %s\n", total_errors == 0 ? "PASSED" : "FAILED");
+    return total_errors == 0 ? 0 : 1;
+}
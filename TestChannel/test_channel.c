@@ -0,0 +1,205 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Samples sent through a channel (see LibraryFreeRTOS_RP2040Channel.h) by N_PRODUCERS producers
+// pinned on core 0 to a consumer pinned on core 1, one executable per backend.
+// The consumer first sends and receives N_COST samples by itself, to measure the cost of a send
+// and of a receive without waiting. Then, for each period in periods_us, every producer sends
+// N_SAMPLES samples, one per period (0: as fast as the channel takes them). The verifier prints,
+// for each period, the throughput, the time spent by the producers in a send (waiting included)
+// and the latency of a sample from its send to its receive.
+
+#ifndef N_PRODUCERS
+#define N_PRODUCERS 1
+#endif
+
+#define N_SAMPLES 1000  // Samples sent by each producer at every period.
+#define N_COST 10000
+#define COST_BATCH (RP2040config_CHANNEL_LENGTH/2)
+
+static const uint32_t periods_us[] = {0, 20, 200};
+#define N_PERIODS (sizeof(periods_us)/sizeof(periods_us[0]))
+
+// The latency is measured across the cores, while SysTick counts the cycles of each core:
+// with it, the latency is read from the microsecond timer.
+#if RP2040config_TIMING_BACKEND == RP2040_TIMING_SYSTICK
+#define LATENCY_UNIT "us"
+typedef uint64_t latency_stamp_t;
+#define latency_now() time_us_64()
+#define latency_since(stamp) (time_us_64() - (stamp))
+#define latency_to_ns(latency) ((latency) * 1000u)
+#else
+#define LATENCY_UNIT RP2040_TIME_UNIT
+typedef timing_stamp_t latency_stamp_t;
+#define latency_now() timing_now()
+#define latency_since(stamp) timing_raw_diff((stamp), timing_now())
+#define latency_to_ns(latency) timing_to_ns(latency)
+#endif
+
+#define SAMPLE(producer, sequence) (((uint32_t) (producer) << 24) | (sequence))
+#define SAMPLE_PRODUCER(sample) ((sample) >> 24)
+#define SAMPLE_SEQUENCE(sample) ((sample) & 0xFFFFFFu)
+
+static struct sample_channel channel;
+static TaskHandle_t producerHandles[N_PRODUCERS];
+static TaskHandle_t consumerHandle = NULL;
+static TaskHandle_t verifierHandle = NULL;
+DECLARE_TASK_STORAGE(task_storage, N_PRODUCERS + 1, RP2040config_tskSLAVE_STACK_SIZE)
+static struct completion_barrier finished;     // The producers and the consumer arrive on it before exiting.
+
+static latency_stamp_t sent_at[N_PRODUCERS][N_SAMPLES];    // Written by the producer before the send.
+static uint64_t send_time[N_PRODUCERS][N_PERIODS];
+static struct run_stats latency[N_PERIODS];
+static uint64_t throughput[N_PERIODS];                      // Samples per second.
+static uint64_t send_cost, receive_cost;
+static uint32_t periods_open = 0;                           // Periods the consumer is ready for.
+static bool cost_ok = true, in_order = true;
+
+// Pace a producer on the microsecond timer (on the host, let the other tasks run meanwhile).
+static void wait_until_us(uint64_t deadline){
+    while(time_us_64() < deadline){
+#ifdef RP2040_HOST_BUILD
+        taskYIELD();
+#else
+        tight_loop_contents();
+#endif
+    }
+}
+
+static void vProducerFunction(void *pvParameters){
+    uint32_t producer = (uint32_t) (uintptr_t) pvParameters;
+    for(uint32_t period=0; period<N_PERIODS; ++period){
+        while(__atomic_load_n(&periods_open, __ATOMIC_ACQUIRE) <= period){
+            vTaskDelay(1);
+        }
+        uint64_t start = time_us_64();
+        for(uint32_t sequence=0; sequence<N_SAMPLES; ++sequence){
+            wait_until_us(start + (uint64_t) sequence * periods_us[period]);
+            sent_at[producer][sequence] = latency_now();
+            save_time_now();
+            sample_channel_send(&channel, producer, SAMPLE(producer, sequence), portMAX_DELAY);
+            send_time[producer][period] += calc_time_diff();
+        }
+    }
+    completion_barrier_arrive(&finished);
+    vTaskDelete(NULL);
+}
+
+// Sends and receives COST_BATCH samples at a time, so that no call waits.
+static void measure_cost(){
+    uint64_t send_total = 0, receive_total = 0;
+    for(uint32_t done=0; done<N_COST; done+=COST_BATCH){
+        uint32_t sent = 0, received = 0;
+        {
+            save_time_now();
+            for(uint32_t k=0; k<COST_BATCH; ++k){
+                cost_ok = sample_channel_send(&channel, k % N_PRODUCERS, done + k, 0) && cost_ok;
+                sent += done + k;
+            }
+            send_total += calc_time_diff();
+        }
+        {
+            save_time_now();
+            for(uint32_t k=0; k<COST_BATCH; ++k){
+                uint32_t sample = 0;
+                cost_ok = sample_channel_receive(&channel, &sample, 0) && cost_ok;
+                received += sample;
+            }
+            receive_total += calc_time_diff();
+        }
+        cost_ok = cost_ok && sent == received;
+    }
+    send_cost = send_total / N_COST;
+    receive_cost = receive_total / N_COST;
+}
+
+static void vConsumerFunction(void *pvParameters){
+    (void) pvParameters;
+    timing_calibrate();
+    measure_cost();
+    for(uint32_t period=0; period<N_PERIODS; ++period){
+        uint32_t next[N_PRODUCERS] = {0};
+        uint64_t elapsed = 0;
+        run_stats_init(&latency[period]);
+        __atomic_store_n(&periods_open, period + 1, __ATOMIC_RELEASE);
+        for(uint32_t i=0; i<N_PRODUCERS*N_SAMPLES; ++i){
+            uint32_t sample = 0;
+            sample_channel_receive(&channel, &sample, portMAX_DELAY);
+            uint32_t producer = SAMPLE_PRODUCER(sample);
+            if(producer >= N_PRODUCERS || SAMPLE_SEQUENCE(sample) != next[producer]){
+                in_order = false;
+                continue;
+            }
+            run_stats_add(&latency[period], latency_since(sent_at[producer][next[producer]]));
+            next[producer]++;
+        }
+        for(uint32_t p=0; p<N_PRODUCERS; ++p){
+            uint64_t since_first = latency_since(sent_at[p][0]);
+            elapsed = since_first > elapsed ? since_first : elapsed;
+        }
+        uint64_t elapsed_ns = latency_to_ns(elapsed);
+        throughput[period] = elapsed_ns > 0 ? (uint64_t) N_PRODUCERS*N_SAMPLES*1000000000ull / elapsed_ns : 0;
+    }
+    completion_barrier_arrive(&finished);
+    vTaskDelete(NULL);
+}
+
+static void print_latency(uint32_t period, struct run_stats *stats){
+    printf("test_channel> latency_%luus:\t n=%lu min=%llu median=%llu mean=%llu p99=%llu max=%llu %s\n",
+        (unsigned long) periods_us[period],
+        (unsigned long) stats->count,
+        (unsigned long long) stats->min,
+        (unsigned long long) (p2_value(&stats->median) + 0.5),
+        (unsigned long long) (stats->mean + 0.5),
+        (unsigned long long) (p2_value(&stats->p99) + 0.5),
+        (unsigned long long) stats->max,
+        LATENCY_UNIT);
+}
+
+static void vTaskVerifier(){
+    completion_barrier_wait(&finished);
+    bool ok = cost_ok && in_order;
+    printf("test_channel> backend:\t " CHANNEL_NAME ", %lu producers \n", (unsigned long) N_PRODUCERS);
+    printf("test_channel> cost:\t send %llu, receive %llu " RP2040_TIME_UNIT " per sample \n",
+        (unsigned long long) send_cost, (unsigned long long) receive_cost);
+    for(uint32_t period=0; period<N_PERIODS; ++period){
+        uint64_t sending = 0;
+        for(uint32_t p=0; p<N_PRODUCERS; ++p){
+            sending += send_time[p][period];
+        }
+        printf("test_channel> period_%luus:\t throughput %llu samples/s, send %llu " RP2040_TIME_UNIT " per sample \n",
+            (unsigned long) periods_us[period], (unsigned long long) throughput[period],
+            (unsigned long long) (sending / (N_PRODUCERS*N_SAMPLES)));
+        print_latency(period, &latency[period]);
+        ok = ok && latency[period].count == N_PRODUCERS*N_SAMPLES;
+    }
+    printf("test_channel> %s\n", ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    if(!sample_channel_init(&channel, N_PRODUCERS)){
+        printf("test_channel> FAILED\n");
+        return -1;
+    }
+
+    for(uint32_t p=0; p<N_PRODUCERS; ++p){
+        create_pinned_task(vProducerFunction, "vProducerFunction", (void *) (uintptr_t) p, 0,
+            RP2040config_tskSLAVE_STACK_SIZE, &producerHandles[p], TASK_STORAGE(task_storage, p));
+    }
+    create_pinned_task(vConsumerFunction, "vConsumerFunction", NULL, 1, RP2040config_tskSLAVE_STACK_SIZE,
+        &consumerHandle, TASK_STORAGE(task_storage, N_PRODUCERS));
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        &verifierHandle);
+    completion_barrier_init(&finished, N_PRODUCERS + 1, verifierHandle);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,128 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Results compared according to their type (see LibraryFreeRTOS_RP2040Compare.h):
+// - test_compare_exact: a float polynomial compared with DEFAULT_CHECK. The cores run the same
+//   soft-float code, so they must always agree, with no error.
+// - test_compare_order: a float sum accumulated in a different order on each core, compared
+//   with ULP_CHECK. The cores differ by a few ULP, which must be accepted and recorded.
+// The verifier also checks the comparators on known values, structures included.
+
+#define N_TERMS 64
+
+struct sample{
+    uint32_t channel;
+    float value;
+};
+
+static float polynomial(float x){
+    float result = 0.0f;
+    for(int i=0; i<N_TERMS; ++i){
+        result = result*x + 1.0f/(float) (i+1);
+    }
+    return result;
+}
+
+// Harmonic sum, from the largest term on core 0 and from the smallest one on core 1.
+static float harmonic(float scale){
+    float sum = 0.0f;
+    for(int i=0; i<N_TERMS; ++i){
+        int term = get_core_num() == 0 ? i : N_TERMS-1-i;
+        sum += scale/(float) (term+1);
+    }
+    return sum;
+}
+
+static bool order_check(float a, float b){
+    return ULP_CHECK(a, b);
+}
+
+static bool sample_check(struct sample a, struct sample b){
+    return GENERIC_CHECK(a.channel, b.channel) && ULP_CHECK(a.value, b.value);
+}
+
+create_multicore_function_validator(test_compare_exact,
+    float,
+    "%f",
+    polynomial,
+    DEFAULT_CHECK,
+    0.5f)
+
+create_multicore_function_validator(test_compare_order,
+    float,
+    "%f",
+    harmonic,
+    order_check,
+    0.1f)
+
+static float next_float(float value, int ulps){
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits += (uint32_t) ulps;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Comparators on values whose distance is known.
+static bool check_comparators(){
+    struct sample a, b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    a.channel = b.channel = 3;
+    a.value = 1.0f;
+    b.value = next_float(1.0f, 2);
+    uint32_t x = 0x0F, y = 0x0C, high = 0x80000000u;
+    int32_t minus_one = -1;
+    double one = 1.0;
+    float nan = __builtin_nanf(""), infinity = __builtin_inff();
+    return compare_ulp_float(1.0f, next_float(1.0f, 1)) == 1 &&
+        compare_ulp_float(-0.0f, 0.0f) == 0 &&
+        compare_ulp_float(-next_float(0.0f, 1), next_float(0.0f, 1)) == 2 &&
+        compare_ulp_double(one, one) == 0 &&
+        compare_ulp_float(nan, nan) == 0 && compare_ulp_float(infinity, infinity) == 0 &&
+        compare_ulp_float(infinity, -infinity) == UINT64_MAX && compare_ulp_float(nan, 1.0f) == UINT64_MAX &&
+        compare_ulp_float(infinity, next_float(infinity, -1)) == UINT64_MAX && !ULP_CHECK(infinity, nan) &&
+        ULP_CHECK(1.0f, next_float(1.0f, RP2040config_CHECK_MAX_ULP)) &&
+        !ULP_CHECK(1.0f, next_float(1.0f, RP2040config_CHECK_MAX_ULP+1)) &&
+        EPSILON_CHECK(1000.0, 1000.0 + 1000.0*RP2040config_CHECK_EPSILON/2) &&
+        !EPSILON_CHECK(1000.0, 1000.0 + 1000.0*RP2040config_CHECK_EPSILON*2) &&
+        !BITWISE_CHECK(-0.0f, 0.0f) &&
+        DEFAULT_CHECK(x, 0x0Fu) && !DEFAULT_CHECK(x, y) && CHECK_ERROR(x, y) == 3 &&
+        CHECK_ERROR(high, 0x7FFFFFFFu) == 1 && CHECK_ERROR(minus_one, 1) == 2 &&
+        CHECK_ERROR(minus_one, INT32_MIN) == 0x7FFFFFFFu &&
+        !DEFAULT_CHECK(a, b) && sample_check(a, b) && CHECK_ERROR(a.value, b.value) == 2 &&
+        CHECK_ERROR(a, b) == compare_bits(&a.value, &b.value, sizeof(a.value));
+}
+
+// Waits for both validators, then checks the errors they have recorded.
+static void vTaskVerifier(){
+    wait_test_runner();
+    uint32_t runs = RP2040config_testWARMUP_RUNS + RP2040config_testREPEAT_RUNS;
+    const struct check_errors *exact = &check_errors_test_compare_exact;
+    const struct check_errors *order = &check_errors_test_compare_order;
+    bool comparators_ok = check_comparators();
+    bool exact_ok = exact->count == runs && exact->max == 0 && retry_stats_test_compare_exact.retries == 0;
+    bool order_ok = order->count == runs && order->max > 0 && order->max <= RP2040config_CHECK_MAX_ULP &&
+        retry_stats_test_compare_order.retries == 0;
+    printf("test_compare> comparators:\t %s \n", comparators_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_compare> exact:\t %s \n", exact_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_compare> order:\t %s \n", order_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_compare> %s\n", comparators_ok && exact_ok && order_ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,147 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Outputs validated through their digests (see LibraryFreeRTOS_RP2040Digest.h):
+// - test_digest_agree: both cores write the same pseudo-random sequence, the digests must agree.
+// - test_digest_fault: core 1 flips a bit of its output the first time it runs, so the first
+//   attempt must be retried, and the mismatch located at the byte flipped.
+// The verifier checks the digest on known values, then compares the time taken by memcmp with the
+// time taken to digest a buffer (paid by every core in parallel, while it writes its output) and
+// to locate a mismatch in its last byte, for buffers from 64 B to BENCH_MAX_SIZE.
+
+#define N_BYTES 8192
+#define CORRUPT_OFFSET 5000
+
+#ifdef RP2040_HOST_BUILD
+#define BENCH_MAX_SIZE 65536
+#else
+#define BENCH_MAX_SIZE 16384
+#endif
+#define BENCH_REPS 32
+
+static bool corrupted = false;
+
+static void produce(struct digest_stream *out, uint32_t seed, bool corrupt){
+    uint32_t state = seed;
+    for(uint32_t offset=0; offset<N_BYTES; offset+=sizeof(state)){
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        uint32_t value = state;
+        if(corrupt && !corrupted && get_core_num() == 1 && offset/sizeof(value) == CORRUPT_OFFSET/sizeof(value)){
+            corrupted = true;
+            value ^= (uint32_t) 1 << (8 * (CORRUPT_OFFSET % sizeof(value)));
+        }
+        digest_put(out, value);
+    }
+}
+
+create_multicore_buffer_validator(test_digest_agree,
+    N_BYTES,
+    produce,
+    0x12345678u,
+    false)
+
+create_multicore_buffer_validator(test_digest_fault,
+    N_BYTES,
+    produce,
+    0x9abcdef0u,
+    true)
+
+static uint8_t bench_a[BENCH_MAX_SIZE];
+static uint8_t bench_b[BENCH_MAX_SIZE];
+static struct digest_stream stream_a, stream_b;
+
+// Digest of the first size bytes of buffer, as if they had been written to the stream.
+static uint32_t digest_filled(struct digest_stream *stream, uint8_t *buffer, size_t size){
+    digest_init(stream, buffer, size);
+    stream->size = size;
+    return digest_finish(stream);
+}
+
+// Digests on known values: xxHash32 reference vectors, and the same digest whatever the writes.
+static bool check_digest(){
+    static uint8_t buffer[3*RP2040config_DIGEST_CHUNK_SIZE];
+    bool ok = digest_hash("", 0, 0) == 0x02CC5D05u && digest_hash("abc", 3, 0) == 0x32D153FFu;
+    for(size_t i=0; i<sizeof(buffer); ++i){
+        bench_a[i] = (uint8_t) (i * 7);
+    }
+    uint32_t whole = digest_filled(&stream_a, bench_a, sizeof(buffer));
+    digest_init(&stream_b, buffer, sizeof(buffer));
+    for(size_t i=0; i<sizeof(buffer); i+=13){
+        digest_write(&stream_b, bench_a + i, sizeof(buffer) - i < 13 ? sizeof(buffer) - i : 13);
+    }
+    ok = ok && digest_finish(&stream_b) == whole && digest_locate(&stream_a, &stream_b) == DIGEST_AGREE;
+    digest_write(&stream_b, bench_a, 1);    // Past the capacity: dropped, but the sizes differ.
+    ok = ok && digest_finish(&stream_b) != whole && digest_locate(&stream_a, &stream_b) == sizeof(buffer);
+    buffer[RP2040config_DIGEST_CHUNK_SIZE + 3] ^= 0x80;
+    digest_filled(&stream_b, buffer, sizeof(buffer));
+    return ok && digest_locate(&stream_a, &stream_b) == RP2040config_DIGEST_CHUNK_SIZE + 3;
+}
+
+static void bench_digest(){
+    for(size_t i=0; i<BENCH_MAX_SIZE; ++i){
+        bench_a[i] = bench_b[i] = (uint8_t) (i * 31 + 7);
+    }
+    for(size_t size=64; size<=BENCH_MAX_SIZE; size*=4){
+        uint64_t memcmp_time = 0, digest_time = 0, locate_time = 0;
+        int differ = 0;
+        for(int rep=0; rep<BENCH_REPS; ++rep){
+            {
+                save_time_now();
+                differ += memcmp(bench_a, bench_b, size) != 0;
+                memcmp_time += calc_time_diff();
+            }
+            {
+                save_time_now();
+                differ += digest_filled(&stream_a, bench_a, size) != digest_filled(&stream_b, bench_b, size);
+                digest_time += calc_time_diff() / 2;    // One digest per core.
+            }
+        }
+        bench_b[size-1] ^= 1;
+        digest_filled(&stream_b, bench_b, size);
+        for(int rep=0; rep<BENCH_REPS; ++rep){
+            save_time_now();
+            differ += digest_locate(&stream_a, &stream_b) != size-1;
+            locate_time += calc_time_diff();
+        }
+        bench_b[size-1] ^= 1;
+        printf("test_digest> bench_%lu:\t memcmp %llu, digest %llu, locate %llu " RP2040_TIME_UNIT "%s\n",
+            (unsigned long) size, (unsigned long long) (memcmp_time/BENCH_REPS),
+            (unsigned long long) (digest_time/BENCH_REPS), (unsigned long long) (locate_time/BENCH_REPS),
+            differ == 0 ? "" : " (WRONG)");
+    }
+}
+
+// Waits for both validators, then checks where they have located the mismatches.
+static void vTaskVerifier(){
+    wait_test_runner();
+    bool digest_ok = check_digest();
+    bool agree_ok = digest_mismatch(test_digest_agree) == DIGEST_AGREE &&
+        retry_stats_test_digest_agree.retries == 0 &&
+        return_info_test_digest_agree[0].stream.size == N_BYTES;
+    bool fault_ok = digest_mismatch(test_digest_fault) == CORRUPT_OFFSET &&
+        retry_stats_test_digest_fault.retries == 1 && retry_stats_test_digest_fault.failed_runs == 0;
+    printf("test_digest> digest:\t %s \n", digest_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_digest> agree:\t %s \n", agree_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_digest> fault:\t %s \n", fault_ok ? "EQUALS" : "NOT_EQUALS");
+    bench_digest();
+    printf("test_digest> %s\n", digest_ok && agree_ok && fault_ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
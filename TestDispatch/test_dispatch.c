@@ -0,0 +1,42 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+#define type_t int32_t
+#ifndef N_DISPATCH
+#define N_DISPATCH 1000 // Number of executions of the test used to average the dispatch time.
+#endif
+
+static uint32_t n_checks = 0;
+
+#pragma GCC push_options
+#pragma GCC optimize ("O0")
+
+static type_t addition(type_t num1, type_t num2){
+    return num1+num2;
+}
+
+#pragma GCC pop_options
+
+// Reports a mismatch for the first N_DISPATCH-1 checks, so that the master goes through
+// its retry loop N_DISPATCH times and the dispatch cost can be averaged.
+static bool check_after_n_dispatches(type_t return_core_0, type_t return_core_1) {
+    n_checks++;
+    return n_checks >= N_DISPATCH && return_core_0 == return_core_1;
+}
+
+create_multicore_function_validator(test_dispatch, 
+    type_t, 
+    "%ld", 
+    addition,
+    check_after_n_dispatches,
+    10,
+    3)
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_dispatch);
+
+    start_FreeRTOS();
+}
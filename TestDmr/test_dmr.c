@@ -0,0 +1,82 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Long computation split in N_SEGMENTS segments, run in lockstep by the two cores.
+// Core 1 flips one bit of its state in the middle of segment FAULT_SEGMENT, the first time only:
+// the divergence must be located at that segment and checkpoint, the segment rerun from
+// the last agreed state, and the final state must be the one of a run without faults.
+
+#define N_SEGMENTS 16
+#define STEPS 1000          // Steps per segment.
+#define CHECKPOINT_EVERY 250
+#define FAULT_SEGMENT 5
+#define FAULT_STEP 600      // Between the third and the fourth checkpoint (index 2).
+
+struct state{
+    uint32_t words[8];
+};
+
+static void init_state(struct state *state);
+static void run_segment(struct state *state, uint32_t segment);
+
+create_multicore_dmr_validator(test_dmr, struct state, init_state, run_segment, N_SEGMENTS)
+
+static volatile bool fault_injected = false;
+
+static void init_state(struct state *state){
+    for(uint32_t i=0; i<8; ++i){
+        state->words[i] = i*2654435761u + 1;
+    }
+}
+
+static void step(struct state *state, uint32_t n){
+    uint32_t *w = state->words;
+    w[n % 8] ^= w[(n + 3) % 8] << 7 | w[(n + 5) % 8] >> 25;
+    w[(n + 1) % 8] += w[n % 8] * 0x9e3779b9u;
+}
+
+static void run_segment(struct state *state, uint32_t segment){
+    for(uint32_t s=0; s<STEPS; ++s){
+        step(state, segment*STEPS + s);
+        if(segment == FAULT_SEGMENT && s == FAULT_STEP && get_core_num() == 1 && !fault_injected){
+            fault_injected = true;
+            state->words[3] ^= 1u << 11;
+        }
+        if((s + 1) % CHECKPOINT_EVERY == 0){
+            dmr_checkpoint(test_dmr, state->words);
+        }
+    }
+}
+
+// Waits for the validator and compares its result with the same computation run here.
+static void vTaskVerifier(){
+    struct state expected;
+
+    wait_test_runner();
+    init_state(&expected);
+    for(uint32_t segment=0; segment<N_SEGMENTS; ++segment){
+        for(uint32_t s=0; s<STEPS; ++s){
+            step(&expected, segment*STEPS + s);
+        }
+    }
+    bool same = memcmp(&expected, &dmr_result(test_dmr), sizeof(expected)) == 0;
+    printf("test_dmr> expected_state:\t %s \n", same ? "EQUALS" : "NOT_EQUALS");
+    printf("test_dmr> %s\n", same && fault_injected ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,135 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Faults injected by the validators, at RP2040config_FAULT_RATE_PPM or at the rate given to configure_faults:
+// - test_fault_exact: results flipped or cores delayed, compared with DEFAULT_CHECK.
+//   Every flip must be detected and no delay can fail the check.
+// - test_fault_tolerant: the same faults, compared allowing a difference up to TOLERANCE.
+//   The flips of the low bits must be missed, the other ones detected.
+// - test_fault_task: inputs corrupted on one core in the task validator, at TASK_RATE_PPM.
+//   Every corruption must be detected, since the slaves compute an injective function.
+
+#if !RP2040config_USE_FAULT_INJECTION
+#error "test_fault must be built with RP2040config_USE_FAULT_INJECTION=1"
+#endif
+
+#define type_t int32_t
+
+#define TOLERANCE 255
+#define N_ITER 1000 // Number of inputs processed by test_fault_task.
+#define TASK_RATE_PPM 50000
+
+static type_t compute(type_t num){
+    type_t result = num;
+    for(int i=0; i<100; ++i){
+        result = result*31 + i;
+    }
+    return result;
+}
+
+static bool tolerant_check(type_t a, type_t b){
+    int64_t difference = (int64_t) a - (int64_t) b;
+    return difference >= -TOLERANCE && difference <= TOLERANCE;
+}
+
+create_multicore_function_validator(test_fault_exact,
+    type_t,
+    "%ld",
+    compute,
+    DEFAULT_CHECK,
+    42)
+
+create_multicore_function_validator(test_fault_tolerant,
+    type_t,
+    "%ld",
+    compute,
+    tolerant_check,
+    42)
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_fault_task,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static uint32_t count;
+static uint32_t failures;
+
+static void vTaskMasterSetup(){
+    count = 0;
+    failures = 0;
+}
+
+static void vTaskMasterLoop(){
+    uint32_t result;
+    bool outcome;
+
+    if(count == N_ITER){
+        exit_test_pipeline(test_fault_task)
+        return;
+    }
+
+    prepare_input_for_slaves(test_fault_task, count)
+
+    receive_output_from_slaves(test_fault_task, DEFAULT_CHECK, result, outcome)
+    (void) result;
+    if(!outcome){
+        failures++;
+    }
+    count++;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    return 3*(*((uint32_t*) param)) + 1;
+}
+
+// Waits for the three validators, then checks how their faults have been classified.
+static void vTaskVerifier(){
+    wait_test_runner();
+    const struct fault_stats *exact = &fault_stats_test_fault_exact;
+    const struct fault_stats *tolerant = &fault_stats_test_fault_tolerant;
+    const struct fault_stats *task = &fault_stats_test_fault_task;
+    bool exact_ok = exact->injected > 0 && exact->delays > 0 &&
+        exact->detected == exact->injected && exact->false_positives == 0;
+    bool tolerant_ok = tolerant->missed > 0 && tolerant->detected > 0 &&
+        tolerant->detected + tolerant->missed == tolerant->injected && tolerant->false_positives == 0;
+    bool task_ok = task->injected > 0 && task->detected == task->injected &&
+        task->false_positives == 0 && failures == task->detected;
+    printf("test_fault> exact:\t %s \n", exact_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_fault> tolerant:\t %s \n", tolerant_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_fault> task:\t %s \n", task_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_fault> %s\n", exact_ok && tolerant_ok && task_ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    configure_faults(test_fault_exact, FAULT_FLIP_RESULT | FAULT_DELAY_CORE, RP2040config_FAULT_RATE_PPM, 1);
+    configure_faults(test_fault_tolerant, FAULT_FLIP_RESULT, RP2040config_FAULT_RATE_PPM, 2);
+    configure_faults(test_fault_task, FAULT_CORRUPT_INPUT, TASK_RATE_PPM, 3);
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,229 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "LibraryFreeRTOS_RP2040Locks.h"
+#include "ApplicationHooks.h"
+#include "hardware/claim.h"
+#include "hardware/sync.h"
+
+// Same workload as TestSemaphores: core 0 increments the shared variable N_ITER times
+// while core 1 decrements it, each access protected by the lock selected at compile time
+// (USE_LOCK_<NAME>, see CMakeLists.txt). Every round must end with the variable at 0.
+//
+// Reported per core: the time of the round (statistics over the rounds) and the throughput
+// in operations per second; then the fairness of the lock (Jain's index of the throughputs,
+// 1 when the cores progress at the same rate) and how often the lock changed core.
+
+#define type_t int32_t
+
+#ifndef N_ITER
+#define N_ITER 1000
+#endif
+
+#ifndef LOCK_NAME
+#define LOCK_NAME "none"
+#endif
+
+#define ROUNDS (RP2040config_testWARMUP_RUNS + RP2040config_testREPEAT_RUNS)
+
+#if RP2040config_testRUN_ON_CORES != 2
+#error "test_locks runs the workload on two cores"
+#endif
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_locks,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static type_t shared_variable = 0;
+static int32_t last_owner = -1;     // core which held the lock last, written inside the lock
+static uint32_t handoffs = 0;       // times the lock has been taken by the other core
+
+#if defined(USE_LOCK_BINARY_SEMAPHORE) || defined(USE_LOCK_MUTEX)
+static SemaphoreHandle_t lock_sem;
+#endif
+#ifdef USE_LOCK_HW_SPINLOCK
+static spin_lock_t *spin_lock;
+#endif
+#ifdef USE_LOCK_PETERSON
+static struct peterson_lock peterson;
+#endif
+#ifdef USE_LOCK_TICKET
+static struct ticket_lock ticket;
+#endif
+#ifdef USE_LOCK_SHARDED
+create_sharded_accumulator(counter, type_t)
+#endif
+
+static void lock_init(){
+    #if defined(USE_LOCK_BINARY_SEMAPHORE)
+    lock_sem = xSemaphoreCreateBinary();
+    xSemaphoreGive(lock_sem);
+    #elif defined(USE_LOCK_MUTEX)
+    lock_sem = xSemaphoreCreateMutex();     // Priority inheritance.
+    #elif defined(USE_LOCK_HW_SPINLOCK)
+    spin_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    #elif defined(USE_LOCK_PETERSON)
+    peterson_init(&peterson);
+    #elif defined(USE_LOCK_TICKET)
+    ticket_init(&ticket);
+    #endif
+}
+
+#pragma GCC push_options
+#pragma GCC optimize ("O0")
+
+static void shared_update(uint32_t core, type_t delta){
+    (void) core;    // Not needed by every lock.
+    for(uint32_t i=0;i<N_ITER;++i){
+        #if defined(USE_LOCK_BINARY_SEMAPHORE) || defined(USE_LOCK_MUTEX)
+        xSemaphoreTake(lock_sem, portMAX_DELAY);
+        #elif defined(USE_LOCK_HW_CLAIM)
+        uint32_t saved = hw_claim_lock();
+        #elif defined(USE_LOCK_HW_SPINLOCK)
+        uint32_t saved = spin_lock_blocking(spin_lock);
+        #elif defined(USE_LOCK_PETERSON)
+        peterson_lock(&peterson, core);
+        #elif defined(USE_LOCK_TICKET)
+        ticket_lock(&ticket, core);
+        #elif defined(USE_LOCK_CRITICAL)
+        taskENTER_CRITICAL();
+        #endif
+
+        #ifdef USE_LOCK_SHARDED
+        sharded_add(counter, delta);    // No lock: nothing to hand off.
+        #else
+        shared_variable += delta;
+        if(last_owner != (int32_t) core){
+            handoffs++;
+            last_owner = (int32_t) core;
+        }
+        #endif
+
+        #if defined(USE_LOCK_BINARY_SEMAPHORE) || defined(USE_LOCK_MUTEX)
+        xSemaphoreGive(lock_sem);
+        #elif defined(USE_LOCK_HW_CLAIM)
+        hw_claim_unlock(saved);
+        #elif defined(USE_LOCK_HW_SPINLOCK)
+        spin_unlock(spin_lock, saved);
+        #elif defined(USE_LOCK_PETERSON)
+        peterson_unlock(&peterson, core);
+        #elif defined(USE_LOCK_TICKET)
+        ticket_unlock(&ticket, core);
+        #elif defined(USE_LOCK_CRITICAL)
+        taskEXIT_CRITICAL();
+        #endif
+    }
+}
+
+#pragma GCC pop_options
+
+static type_t shared_read(){
+    #ifdef USE_LOCK_SHARDED
+    return sharded_merge(counter);
+    #else
+    return shared_variable;
+    #endif
+}
+
+static void shared_reset(){
+    shared_variable = 0;
+    last_owner = -1;
+    handoffs = 0;
+    #ifdef USE_LOCK_SHARDED
+    sharded_reset(counter, 0)
+    #endif
+}
+
+static uint32_t round_count;
+static uint32_t errors;             // rounds not ending with the shared variable at 0
+static uint64_t handoffs_total;
+static struct run_stats round_stats[RP2040config_testRUN_ON_CORES];
+
+static void vTaskMasterSetup(){
+    round_count = 0;
+    errors = 0;
+    handoffs_total = 0;
+    lock_init();
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        run_stats_init(&round_stats[i]);
+    }
+}
+
+static void print_report(){
+    double throughput[RP2040config_testRUN_ON_CORES];
+    double sum = 0, sum_squares = 0;
+
+    printf("test_locks> lock:\t %s \n", LOCK_NAME);
+    printf("test_locks> n_iter:\t %d \n", N_ITER);
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        run_stats_print("test_locks", i, &round_stats[i], RP2040_TIME_UNIT);
+        uint64_t ns = timing_to_ns((uint64_t) round_stats[i].mean);
+        throughput[i] = ns > 0 ? (double) N_ITER * 1e9 / (double) ns : 0;
+        sum += throughput[i];
+        sum_squares += throughput[i]*throughput[i];
+        printf("test_locks> throughput_core_%d:\t %lu ops/s \n", i, (unsigned long) throughput[i]);
+    }
+    double fairness = sum_squares > 0 ? sum*sum / (RP2040config_testRUN_ON_CORES*sum_squares) : 0;
+    printf("test_locks> fairness:\t %lu.%03lu \n",
+        (unsigned long) fairness, (unsigned long) (fairness*1000) % 1000);
+    printf("test_locks> handoffs:\t %lu \n",
+        (unsigned long) (handoffs_total / RP2040config_testREPEAT_RUNS));
+    printf("test_locks> errors:\t %lu \n", (unsigned long) errors);
+    printf("test_locks> %s\n", errors == 0 ? "PASSED" : "FAILED");
+}
+
+static void vTaskMasterLoop(){
+    uint32_t result;
+    bool outcome;
+
+    if(round_count == ROUNDS){
+        print_report();
+        exit_test_pipeline(test_locks)
+        return;
+    }
+
+    shared_reset();
+    prepare_input_for_slaves(test_locks, round_count)
+
+    receive_output_from_slaves(test_locks, DEFAULT_CHECK, result, outcome)
+    (void) result;
+    (void) outcome;
+    if(shared_read() != 0){
+        errors++;
+    }
+    if(round_count >= RP2040config_testWARMUP_RUNS){
+        for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+            run_stats_add(&round_stats[i], return_info_slaves_test_locks[i].return_time);
+        }
+        handoffs_total += handoffs;
+    }
+    round_count++;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    (void) param;
+    uint32_t core = get_core_num();
+    shared_update(core, core == 0 ? 1 : -1);
+    return 0;
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_locks);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,94 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// N_REPLICAS replicas of the same function voted with VOTER (see CMakeLists.txt), one of them
+// returning a wrong value every FAULT_EVERY executions: the vote must always give the right
+// value and blame only the faulty replica. With USE_DUAL the same function is compared by the
+// plain dual-core validator instead, to compare the time of a vote with the one of a dispatch.
+
+#define type_t int32_t
+
+#ifndef N_REPLICAS
+#define N_REPLICAS 3
+#endif
+
+#ifndef VOTER
+#define VOTER majority
+#endif
+
+#define FAULTY_REPLICA (N_REPLICAS - 1)    // Never 0, the replica seen by the dual-core validator.
+#define FAULT_EVERY 4
+
+#ifndef USE_DUAL
+static uint32_t faults = 0;     // Written by the faulty replica only.
+#endif
+
+#pragma GCC push_options
+#pragma GCC optimize ("O0")
+
+static type_t compute(type_t seed, uint32_t rounds){
+    uint32_t value = (uint32_t) seed;
+    for(uint32_t i=0; i<rounds; ++i){
+        value = value*1103515245u + 12345u;
+    }
+    #ifndef USE_DUAL
+    static uint32_t calls = 0;
+    if(nmr_replica_id() == FAULTY_REPLICA && calls++ % FAULT_EVERY == 0){
+        faults++;
+        value += 1000;
+    }
+    #endif
+    return (type_t) (value >> 1);
+}
+
+#pragma GCC pop_options
+
+#ifdef USE_DUAL
+create_multicore_function_validator(test_nmr,
+    type_t,
+    "%ld",
+    compute,
+    DEFAULT_CHECK,
+    7,
+    1000)
+#else
+create_nmr_function_validator(test_nmr,
+    type_t,
+    "%ld",
+    compute,
+    N_REPLICAS,
+    VOTER,
+    7,
+    1000)
+
+// Waits for the validator, then checks the vote and the replicas blamed.
+static void vTaskVerifier(){
+    wait_test_runner();
+    uint32_t errors = 0;
+    for(uint32_t r=0; r<N_REPLICAS; ++r){
+        errors += nmr_disagreements_test_nmr[r] != (r == FAULTY_REPLICA ? faults : 0);
+    }
+    printf("test_nmr> faults:\t %lu \n", (unsigned long) faults);
+    printf("test_nmr> errors:\t %lu \n", (unsigned long) errors);
+    printf("test_nmr> %s\n", errors == 0 && faults > 0 ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+#endif
+
+int main(void) {
+
+    start_hw();
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    #ifndef USE_DUAL
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+    #endif
+
+    start_FreeRTOS();
+}
@@ -65,10 +65,8 @@ int main(void) {
 
     start_hw();
 
-    start_master(test_addition);
-    start_master(test_subtraction);
-    start_master(test_multiplication);
-    start_master(test_division);
+    // One test at a time, so that their slaves do not preempt each other.
+    start_test_runner(RP2040config_TEST_RUN_MODE, RP2040config_TEST_FILTER);
 
 
     start_FreeRTOS();
@@ -0,0 +1,116 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "LibraryFreeRTOS_RP2040Parallel.h"
+#include "ApplicationHooks.h"
+
+// Reduction of an array of N_ELEMENTS words with parallel_reduce, against the same reduction
+// run on a single core. The cost of an element grows along the array, so an even split of the
+// chunks leaves the core with the first half idle: the work stealing must rebalance them.
+//
+// The RP2040 cannot hold 1M words, so on the board the array wraps over DATA_WORDS words.
+
+#ifndef N_ELEMENTS
+#define N_ELEMENTS 1024
+#endif
+
+#define N_CHUNKS 64     // Chunks of the range (before stealing).
+#define ROUNDS 5        // Timed runs of each version.
+
+#if defined(RP2040_HOST_BUILD) || N_ELEMENTS <= 16384
+#define DATA_WORDS N_ELEMENTS
+#else
+#define DATA_WORDS 16384
+#endif
+
+#define CHUNK_SIZE (N_ELEMENTS/N_CHUNKS > 0 ? N_ELEMENTS/N_CHUNKS : 1)
+
+static uint32_t data[DATA_WORDS];
+static struct parallel_pool pool;
+
+static uint64_t add(uint64_t a, uint64_t b){
+    return a + b;
+}
+
+create_parallel_reduce(parallel_sum, uint64_t, 0, add)
+
+// Element i is mixed 1 to 8 times, more towards the end of the array.
+static uint64_t reduce_range(void *ctx, uint32_t begin, uint32_t end){
+    (void) ctx;
+    uint64_t sum = 0;
+    for(uint32_t i=begin; i<end; ++i){
+        uint32_t value = data[i % DATA_WORDS];
+        uint32_t rounds = 1 + (uint32_t) ((uint64_t) i*8/N_ELEMENTS);
+        for(uint32_t r=0; r<rounds; ++r){
+            value ^= value << 13;
+            value ^= value >> 17;
+            value ^= value << 5;
+        }
+        sum += value;
+    }
+    return sum;
+}
+
+static void vTaskParallel(){
+    struct run_stats single_stats, parallel_stats;
+    uint64_t expected = 0, result = 0;
+    uint32_t errors = 0;
+
+    for(uint32_t i=0; i<DATA_WORDS; ++i){
+        data[i] = i*2654435761u + 1;
+    }
+    timing_calibrate();
+    run_stats_init(&single_stats);
+    run_stats_init(&parallel_stats);
+    parallel_pool_start(&pool);
+
+    for(int round=0; round<ROUNDS; ++round){
+        {
+            save_time_now();
+            expected = reduce_range(NULL, 0, N_ELEMENTS);
+            run_stats_add(&single_stats, calc_time_diff());
+        }
+        {
+            save_time_now();
+            result = parallel_sum(&pool, 0, N_ELEMENTS, CHUNK_SIZE, reduce_range, NULL);
+            run_stats_add(&parallel_stats, calc_time_diff());
+        }
+        if(result != expected){
+            errors++;
+        }
+    }
+    parallel_pool_stop(&pool);
+
+    printf("test_parallel> n_elements:\t %lu \n", (unsigned long) N_ELEMENTS);
+    printf("test_parallel> chunk_size:\t %lu \n", (unsigned long) CHUNK_SIZE);
+    run_stats_print("test_parallel_single", 0, &single_stats, RP2040_TIME_UNIT);
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        printf("test_parallel> chunks_core_%d:\t %lu \n", i, (unsigned long) pool.params[i].chunks);
+        printf("test_parallel> steals_core_%d:\t %lu \n", i, (unsigned long) pool.params[i].steals);
+    }
+    run_stats_print("test_parallel", 0, &parallel_stats, RP2040_TIME_UNIT);
+    double speedup = parallel_stats.mean > 0 ? single_stats.mean / parallel_stats.mean : 0;
+#ifdef RP2040_HOST_BUILD
+    // The emulated cores share one thread: this is the overhead of the split, not a speedup.
+    printf("test_parallel> speedup:\t %lu.%02lu (not meaningful on the host, one real core) \n",
+        (unsigned long) speedup, (unsigned long) (speedup*100) % 100);
+#else
+    printf("test_parallel> speedup:\t %lu.%02lu \n",
+        (unsigned long) speedup, (unsigned long) (speedup*100) % 100);
+#endif
+    printf("test_parallel> errors:\t %lu \n", (unsigned long) errors);
+    printf("test_parallel> %s\n", errors == 0 ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    xTaskCreate(vTaskParallel,
+        "vTaskParallel",
+        RP2040config_tskMASTER_STACK_SIZE,
+        NULL,
+        RP2040config_tskMASTER_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
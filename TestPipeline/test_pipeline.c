@@ -0,0 +1,130 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+#define N_ITERATIONS 2000 // Number of inputs submitted before the test ends.
+#define DIRECT_EVERY 100  // Every DIRECT_EVERY inputs, one goes through prepare/receive instead of the pipeline.
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_pipeline,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static uint32_t count;
+static uint32_t submitted;  // inputs submitted to the pipeline
+static uint32_t expected_iteration;
+static uint32_t mismatches; // results compared or returned for the wrong iteration
+static uint32_t errors;     // results of the cores not equal
+static uint32_t history[RP2040config_PIPELINE_DEPTH]; // inputs in flight, by iteration
+
+static uint32_t make_input(uint32_t iteration){
+    return iteration*2654435761u ^ 0x5bd1e995u;
+}
+
+static uint32_t expected_output(uint32_t input){
+    return input*7+1;
+}
+
+static void collect_and_verify(){
+    uint32_t result;
+    bool outcome;
+    uint32_t iteration;
+
+    collect_output_from_slaves(test_pipeline, DEFAULT_CHECK, result, outcome, iteration)
+    if(iteration != expected_iteration){
+        mismatches++;
+    }
+    if(!outcome){
+        errors++;
+    } else if(result != expected_output(history[iteration % RP2040config_PIPELINE_DEPTH])){
+        mismatches++;
+    }
+    expected_iteration++;
+}
+
+// The pipeline is drained first: the completions of the pipelined inputs must not be taken
+// for the ones of the slaves on this input.
+static void run_direct(uint32_t input){
+    uint32_t result;
+    bool outcome;
+
+    while(pipeline_in_flight(test_pipeline) > 0){
+        collect_and_verify();
+    }
+    prepare_input_for_slaves(test_pipeline, input)
+    receive_output_from_slaves(test_pipeline, DEFAULT_CHECK, result, outcome)
+    if(!outcome){
+        errors++;
+    } else if(result != expected_output(input)){
+        mismatches++;
+    }
+}
+
+static void vTaskMasterSetup(){
+    count = 0;
+    submitted = 0;
+    expected_iteration = 0;
+    mismatches = 0;
+    errors = 0;
+}
+
+// Iteration k is submitted while the slaves are still computing k-1,
+// only the oldest iteration is collected when the pipeline is full.
+static void vTaskMasterLoop(){
+    if(count == N_ITERATIONS){
+        while(pipeline_in_flight(test_pipeline) > 0){
+            collect_and_verify();
+        }
+        printf("test_pipeline> iterations:\t %lu \n", (unsigned long) expected_iteration);
+        printf("test_pipeline> mismatches:\t %lu \n", (unsigned long) mismatches);
+        printf("test_pipeline> errors:\t %lu \n", (unsigned long) errors);
+        printf("test_pipeline> %s\n",
+            mismatches == 0 && errors == 0 && expected_iteration == N_ITERATIONS - N_ITERATIONS/DIRECT_EVERY ?
+            "PASSED" : "FAILED");
+        exit_test_pipeline(test_pipeline)
+        return;
+    }
+    uint32_t input = make_input(count);
+    if(count % DIRECT_EVERY == DIRECT_EVERY - 1){
+        run_direct(input);
+        count++;
+        return;
+    }
+    if(pipeline_full(test_pipeline)){
+        collect_and_verify();
+    }
+    history[submitted % RP2040config_PIPELINE_DEPTH] = input;
+    submit_input_to_slaves(test_pipeline, input)
+    submitted++;
+    count++;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+// The cores are delayed on different inputs, so that they drift apart inside the pipeline.
+static uint32_t vTaskSlaveLoop(void* param){
+    uint32_t input = *((uint32_t*) param);
+    if(((input >> (4*get_core_num())) & 7) == 0){
+        vTaskDelay(1);
+    }
+    return expected_output(input);
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_pipeline);
+
+    start_FreeRTOS();
+}
@@ -5,14 +5,15 @@
 #include "pico/stdlib.h"
 #include "pico/rand.h"
 
-#define TEMPERATURE_QUEUE_LENGTH 100
 #define TEMPERATURE_GENERATION_PERIOD 1000
 #define TEMPERATURE_READS 20 // Number of temperature readings to be generated before the test ends.
 #define MASTER_READS 5 // Number of temperature readings to be processed by the master before the test ends.
 #define MASTER_DELAY 500 // half of the period to popolate the temperature queue.
 
-// Define a shared queue and the relative lock between a generic task and the master.
-static QueueHandle_t temperature_queue;
+// Define a shared channel between a generic task and the master (a queue of RP2040config_CHANNEL_LENGTH
+// samples, unless RP2040config_CHANNEL says otherwise, see LibraryFreeRTOS_RP2040Channel.h).
+static struct sample_channel temperature_channel;
+static bool temperature_channel_ready = false;
 
 // Generic task
 static void vTaskTemperatureGenerator(){
@@ -23,8 +24,8 @@ static void vTaskTemperatureGenerator(){
     // Generate a random uniform number (in Kelvin) between 10 and 30 degrees (Celsius).
         uint32_t temp = get_rand_32()%21 + 273 +10;
         printf("Temperature generated: %ld K\n", temp);
-        // This post to the queue copies the value. 
-        if(xQueueSendToBack(temperature_queue, (void*) &temp, 0) != pdPASS){
+        // This post to the channel copies the value. 
+        if(!sample_channel_send(&temperature_channel, 0, temp, 0)){
         // In case it is full then it returns immediately (our value is simulated, nothing happens if its lost).
         }
     }
@@ -48,7 +49,7 @@ create_multicore_task_validator(
 static int count;
 // This function will be executed once at the start of the master.
 static void vTaskMasterSetup(){
-    if(temperature_queue == NULL){
+    if(!temperature_channel_ready){
         // printf("Error during creation of master-slave queue\n");
         vTaskDelete(NULL);
     }
@@ -59,7 +60,7 @@ static void vTaskMasterSetup(){
 // After the execution of this function the master will submit the work to the slaves.
 // Hence here we need to prepare the values for the slaves.
 static void vTaskMasterLoop(){
-    // Read the data from the shared queue
+    // Read the data from the shared channel
     uint32_t temp_read;
     uint32_t result; //returned value from the slaves
     bool outcome; // outcome of the check performed by the slaves
@@ -67,10 +68,10 @@ static void vTaskMasterLoop(){
     if(count == MASTER_READS){
         exit_test_pipeline(test_temperature)
     }
-    while(xQueueReceive(temperature_queue, &temp_read, portMAX_DELAY) == errQUEUE_EMPTY);
+    while(!sample_channel_receive(&temperature_channel, &temp_read, portMAX_DELAY));
 
-    // Copy the data two times in the slave queue
-    prepare_input_for_slaves(test_temperature, temp_read)
+    // Publish the data once, the slaves read it in place
+    publish_input_for_slaves(test_temperature, temp_read)
     
     // From here on the library will wake up the two slave tasks which will do their job
     receive_output_from_slaves(test_temperature, DEFAULT_CHECK, result, outcome)
@@ -105,9 +106,9 @@ int main(void) {
     start_hw();
 
     // NB: this is dynamically allocated. Maybe worth to explore xQueueCreateStatic https://syop.freertos.org/Documentation/02-Kernel/04-API-references/06-Queues/02-xQueueCreateStatic ?
-    temperature_queue = xQueueCreate(TEMPERATURE_QUEUE_LENGTH, sizeof(uint32_t));
+    temperature_channel_ready = sample_channel_init(&temperature_channel, 1);
 
-    if(temperature_queue == NULL){
+    if(!temperature_channel_ready){
         ////printf("Errore creazione coda temperatura\n");
         return -1;
     }
@@ -0,0 +1,87 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Deterministic faults injected on core 1:
+// - test_transient: the first two attempts of every run are wrong, the third one is right.
+// - test_persistent: every attempt is wrong, so every run must be given up after
+//   PERSISTENT_ATTEMPTS attempts and escalated, sleeping for the backoff in between.
+
+#define type_t int32_t
+
+#define TRANSIENT_FAULTS 2
+#define PERSISTENT_ATTEMPTS 4
+#define BACKOFF_TICKS 1
+#define BACKOFF_MAX_TICKS 2
+
+static uint32_t transient_calls = 0;    // Written by core 1 only.
+static uint32_t escalations = 0;
+
+static type_t transient(type_t num){
+    if(get_core_num() == 1 && transient_calls++ % (TRANSIENT_FAULTS + 1) != TRANSIENT_FAULTS){
+        return num + 1;
+    }
+    return num;
+}
+
+static type_t persistent(type_t num){
+    return get_core_num() == 1 ? num + 1 : num;
+}
+
+static void escalate(const char *test_name, uint32_t run, uint32_t attempts){
+    printf("%s> escalation:\t run %lu after %lu attempts\n", test_name, (unsigned long) run, (unsigned long) attempts);
+    escalations++;
+}
+
+create_multicore_function_validator(test_transient,
+    type_t,
+    "%ld",
+    transient,
+    DEFAULT_CHECK,
+    42)
+
+create_multicore_function_validator(test_persistent,
+    type_t,
+    "%ld",
+    persistent,
+    DEFAULT_CHECK,
+    42)
+
+// Waits for both validators, then checks their retry statistics.
+static void vTaskVerifier(){
+    wait_test_runner();
+    uint32_t runs = RP2040config_testWARMUP_RUNS + RP2040config_testREPEAT_RUNS;
+    // Backoff after the failed attempts 1, 2 and 3 of a run: 1, 2 and 2 ticks.
+    TickType_t backoff = 0;
+    for(uint32_t attempt=1; attempt<PERSISTENT_ATTEMPTS; ++attempt){
+        backoff += retry_backoff(&retry_policy_test_persistent, attempt);
+    }
+    bool transient_ok = retry_stats_test_transient.retries == TRANSIENT_FAULTS*runs &&
+        retry_stats_test_transient.failed_runs == 0;
+    bool persistent_ok = retry_stats_test_persistent.retries == (PERSISTENT_ATTEMPTS - 1)*runs &&
+        retry_stats_test_persistent.failed_runs == runs &&
+        retry_stats_test_persistent.backoff_ticks == backoff*runs &&
+        escalations == runs;
+    printf("test_retry> transient:\t %s \n", transient_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_retry> persistent:\t %s \n", persistent_ok ? "EQUALS" : "NOT_EQUALS");
+    printf("test_retry> %s\n", transient_ok && persistent_ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    configure_retry(test_transient, TRANSIENT_FAULTS + 1, 0, 0, NULL);
+    configure_retry(test_persistent, PERSISTENT_ATTEMPTS, BACKOFF_TICKS, BACKOFF_MAX_TICKS, escalate);
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
@@ -5,7 +5,12 @@
 #define type_t int32_t
 #define N_ITER 100
 
+#ifdef USE_SHARDED
+// Every core adds to its own slot, no lock is needed.
+create_sharded_accumulator(shared_shards, type_t)
+#else
 static type_t shared_variable = 0;
+#endif
 
 #ifdef USE_FREERTOS_LOCK
 static SemaphoreHandle_t bin_sem;
@@ -22,7 +27,11 @@ static void shared_addition(){
         #ifdef USE_SDK_LOCK
         uint32_t lock = hw_claim_lock();
         #endif
+        #ifdef USE_SHARDED
+        sharded_add(shared_shards, 1);
+        #else
         shared_variable++;
+        #endif
         #ifdef USE_FREERTOS_LOCK
         xSemaphoreGive(bin_sem);
         }
@@ -41,7 +50,11 @@ static void shared_subtraction(){
         #ifdef USE_SDK_LOCK
         uint32_t lock = hw_claim_lock();
         #endif
+        #ifdef USE_SHARDED
+        sharded_add(shared_shards, -1);
+        #else
         shared_variable--;
+        #endif
         #ifdef USE_FREERTOS_LOCK
         xSemaphoreGive(bin_sem);
         }
@@ -54,6 +67,16 @@ static void shared_subtraction(){
 
 #pragma GCC pop_options
 
+#ifdef USE_SHARDED
+create_multicore_sharded_function_validator(test_ts,
+    type_t,
+    "%ld",
+    DEFAULT_CHECK,
+    0,
+    shared_shards,
+    shared_addition,
+    shared_subtraction)
+#else
 create_multicore_void_function_validator(test_ts, 
     type_t, 
     "%ld", 
@@ -62,6 +85,7 @@ create_multicore_void_function_validator(test_ts,
     shared_variable,
     shared_addition, 
     shared_subtraction)
+#endif
 
 int main(void) {
 
@@ -100,9 +100,8 @@ int main(void) {
     }
     xSemaphoreGive(bin_sem);
 
-    start_master(test_nolock);
-    start_master(test_freertos_lock);
-    start_master(test_sdk_lock);
+    // One test at a time, so that their slaves do not preempt each other.
+    start_test_runner(RP2040config_TEST_RUN_MODE, RP2040config_TEST_FILTER);
 
     start_FreeRTOS();
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+#include <malloc.h>
+
+#define SOAK_ITERATIONS 1000000 // Number of inputs dispatched to the slaves before the test ends.
+#define SOAK_REPORT_PERIOD 100000 // Number of iterations between two reports of the heap usage.
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_soak,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static uint32_t count;
+static uint32_t errors;
+static size_t freertos_heap_start;
+static size_t c_heap_start;
+static bool heap_flat;
+
+// Bytes currently allocated by malloc (newlib on the board, glibc on the host).
+static size_t c_heap_used(){
+#ifdef RP2040_HOST_BUILD
+    return mallinfo2().uordblks;
+#else
+    return mallinfo().uordblks;
+#endif
+}
+
+static void check_heap(){
+    size_t freertos_heap = xPortGetFreeHeapSize();
+    size_t c_heap = c_heap_used();
+    printf("test_soak> iteration:\t %lu \n", (unsigned long) count);
+    printf("test_soak> freertos_heap_free:\t %lu \n", (unsigned long) freertos_heap);
+    printf("test_soak> c_heap_used:\t %lu \n", (unsigned long) c_heap);
+    if(freertos_heap != freertos_heap_start || c_heap != c_heap_start){
+        heap_flat = false;
+    }
+}
+
+static void vTaskMasterSetup(){
+    count = 0;
+    errors = 0;
+    heap_flat = true;
+}
+
+// After the first iteration the slaves have been created and the stdio buffers allocated,
+// from then on the heap usage must not change.
+static void vTaskMasterLoop(){
+    uint32_t result;
+    bool outcome;
+
+    if(count == 1){
+        freertos_heap_start = xPortGetFreeHeapSize();
+        c_heap_start = c_heap_used();
+    }
+    if(count == SOAK_ITERATIONS){
+        check_heap();
+        printf("test_soak> errors:\t %lu \n", (unsigned long) errors);
+        printf("test_soak> %s\n", heap_flat && errors == 0 ? "PASSED" : "FAILED");
+        exit_test_pipeline(test_soak)
+        return;
+    }
+
+    prepare_input_for_slaves(test_soak, count)
+
+    receive_output_from_slaves(test_soak, DEFAULT_CHECK, result, outcome)
+    if(!outcome || result != 2*count){
+        errors++;
+    }
+    count++;
+    if(count % SOAK_REPORT_PERIOD == 0){
+        check_heap();
+    }
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    return 2*(*((uint32_t*) param));
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_master(test_soak);
+
+    start_FreeRTOS();
+}
@@ -0,0 +1,150 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Host only: the records written by the drain task are read back from the telemetry file
+// and checked (CRC, iterations, values). Every record missing must be counted as dropped,
+// and none can be missing unless RP2040config_TELEMETRY_DROP_WHEN_FULL is set.
+
+#define N_ITER 5000 // Number of inputs processed before the test ends.
+
+#if !RP2040config_USE_TELEMETRY || !defined(RP2040_HOST_BUILD)
+#error "test_telemetry must be built for the host with RP2040config_USE_TELEMETRY=1"
+#endif
+
+static void vTaskMasterSetup();
+static void vTaskMasterLoop();
+static void vTaskSlaveSetup();
+static uint32_t vTaskSlaveLoop(void* param);
+
+create_multicore_task_validator(
+    test_telemetry,
+    vTaskMasterSetup,
+    vTaskMasterLoop,
+    vTaskSlaveSetup,
+    vTaskSlaveLoop,
+    uint32_t,
+    "%lu"
+)
+
+static uint32_t count;
+
+static void vTaskMasterSetup(){
+    count = 0;
+}
+
+static void vTaskMasterLoop(){
+    uint32_t result;
+    bool outcome;
+
+    if(count == N_ITER){
+        exit_test_pipeline(test_telemetry)
+        return;
+    }
+
+    prepare_input_for_slaves(test_telemetry, count)
+
+    receive_output_from_slaves(test_telemetry, DEFAULT_CHECK, result, outcome)
+    (void) result;
+    (void) outcome;
+    count++;
+}
+
+static void vTaskSlaveSetup(){
+}
+
+static uint32_t vTaskSlaveLoop(void* param){
+    return 3*(*((uint32_t*) param));
+}
+
+static uint64_t get_le(const uint8_t *src, size_t size){
+    uint64_t value = 0;
+    for(size_t i=0; i<size; ++i){
+        value |= (uint64_t) src[i] << (8*i);
+    }
+    return value;
+}
+
+// Waits for the master to finish and for its records to be written, then decodes the file.
+static void vTaskVerifier(){
+    static uint8_t data[N_ITER*RP2040config_testRUN_ON_CORES*(24+TELEMETRY_FRAME_OVERHEAD) + 4096];
+    uint32_t names = 0, results = 0, dropped = 0, corrupted = 0, errors = 0;
+    uint32_t last_iteration[RP2040config_testRUN_ON_CORES] = {0};
+    bool seen[RP2040config_testRUN_ON_CORES] = {false};
+
+    wait_test_runner();
+    telemetry_wait_drained(&telemetry_ring_test_telemetry);
+    fflush(telemetry_file);
+
+    FILE *file = fopen(telemetry_path, "rb");
+    if(file == NULL){
+        printf("test_telemetry> cannot open %s\n", telemetry_path);
+        vTaskDelete(NULL);
+    }
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    for(size_t pos=0; pos + TELEMETRY_FRAME_OVERHEAD <= size; ){
+        uint8_t length = data[pos+1];
+        if(data[pos] != TELEMETRY_SYNC || pos + length + TELEMETRY_FRAME_OVERHEAD > size ||
+           telemetry_crc16(0xFFFF, data + pos + 1, length + 2) != get_le(data + pos + 3 + length, 2)){
+            corrupted++;
+            pos++;
+            continue;
+        }
+        const uint8_t *payload = data + pos + 3;
+        switch(data[pos+2]){
+            case TELEMETRY_RECORD_NAME:
+                names++;
+                if(length - 2 != strlen("test_telemetry") || memcmp(payload + 2, "test_telemetry", length - 2) != 0){
+                    errors++;
+                }
+                break;
+            case TELEMETRY_RECORD_RESULT: {
+                uint8_t core = payload[2];
+                uint32_t iteration = (uint32_t) get_le(payload + 4, 4);
+                if(core >= RP2040config_testRUN_ON_CORES || payload[3] != (TELEMETRY_KIND_UNSIGNED << 4 | 4) ||
+                   get_le(payload + 8, 4) != 3*iteration || (seen[core] && iteration <= last_iteration[core])){
+                    errors++;
+                    break;
+                }
+                seen[core] = true;
+                last_iteration[core] = iteration;
+                results++;
+                break;
+            }
+            case TELEMETRY_RECORD_DROPPED:
+                dropped += (uint32_t) get_le(payload + 2, 4);
+                break;
+            default:
+                errors++;
+        }
+        pos += length + TELEMETRY_FRAME_OVERHEAD;
+    }
+
+    printf("test_telemetry> ring_size:\t %d \n", RP2040config_TELEMETRY_RING_SIZE);
+    printf("test_telemetry> results:\t %lu \n", (unsigned long) results);
+    printf("test_telemetry> dropped:\t %lu \n", (unsigned long) dropped);
+    printf("test_telemetry> corrupted:\t %lu \n", (unsigned long) corrupted);
+    printf("test_telemetry> errors:\t %lu \n", (unsigned long) errors);
+    printf("test_telemetry> %s\n",
+        names == 1 && corrupted == 0 && errors == 0 &&
+        (RP2040config_TELEMETRY_DROP_WHEN_FULL || dropped == 0) &&
+        results + dropped == N_ITER*RP2040config_testRUN_ON_CORES ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    start_test_runner(TEST_RUN_PARALLEL, NULL);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        NULL);
+
+    start_FreeRTOS();
+}
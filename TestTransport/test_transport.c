@@ -0,0 +1,88 @@
+#include "LibraryFreeRTOS_RP2040.h"
+#include "ApplicationHooks.h"
+
+// Ping-pong between a task pinned on core 0 and one pinned on core 1, through two transports
+// (see LibraryFreeRTOS_RP2040Transport.h): each round trip is one signal in each direction.
+// test_transport uses task notifications, test_transport_fifo the lock-free FIFO. After
+// N_WARMUP rounds the verifier prints the statistics of the round trip over N_ROUNDS rounds.
+
+#define N_WARMUP 100
+#define N_ROUNDS 10000
+
+static struct transport to_pong, to_ping;
+static struct run_stats round_trip;
+static TaskHandle_t pingHandle = NULL, pongHandle = NULL, verifierHandle = NULL;
+static struct completion_barrier finished;     // Ping and pong arrive on it before exiting.
+static uint32_t rounds_done = 0, sequence = 0;
+static bool in_order = true;
+
+static void vPingFunction(void *pvParameters){
+    (void) pvParameters;
+    timing_calibrate();
+    run_stats_init(&round_trip);
+    for(uint32_t round=0; round<N_WARMUP+N_ROUNDS; ++round){
+        save_time_now();
+        sequence = round;           // Read by pong after the signal.
+        transport_signal(&to_pong);
+        transport_wait(&to_ping);
+        uint64_t elapsed = calc_time_diff();
+        if(sequence != round + 1){  // Written by pong before its signal.
+            in_order = false;
+        }
+        if(round >= N_WARMUP){
+            run_stats_add(&round_trip, elapsed);
+            rounds_done++;
+        }
+    }
+    completion_barrier_arrive(&finished);
+    vTaskDelete(NULL);
+}
+
+static void vPongFunction(void *pvParameters){
+    (void) pvParameters;
+    for(uint32_t round=0; round<N_WARMUP+N_ROUNDS; ++round){
+        transport_wait(&to_pong);
+        if(sequence != round){
+            in_order = false;
+        }
+        sequence = round + 1;
+        transport_signal(&to_ping);
+    }
+    completion_barrier_arrive(&finished);
+    vTaskDelete(NULL);
+}
+
+static void vTaskVerifier(){
+    completion_barrier_wait(&finished);
+    bool ok = rounds_done == N_ROUNDS && in_order;
+    printf("test_transport> backend:\t " TRANSPORT_NAME " \n");
+    run_stats_print("test_transport", 0, &round_trip, RP2040_TIME_UNIT);
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    printf("test_transport> blocks:\t ping %lu, pong %lu \n", (unsigned long) to_ping.fifo.blocks,
+        (unsigned long) to_pong.fifo.blocks);
+#endif
+    printf("test_transport> %s\n", ok ? "PASSED" : "FAILED");
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+
+    start_hw();
+
+    create_pinned_task(vPingFunction, "vPingFunction", NULL, 0, RP2040config_tskSLAVE_STACK_SIZE,
+        &pingHandle, NULL, NULL);
+    create_pinned_task(vPongFunction, "vPongFunction", NULL, 1, RP2040config_tskSLAVE_STACK_SIZE,
+        &pongHandle, NULL, NULL);
+    transport_init(&to_pong, pongHandle);
+    transport_init(&to_ping, pingHandle);
+
+    xTaskCreate(vTaskVerifier,
+        "vTaskVerifier",
+        configMINIMAL_STACK_SIZE,
+        NULL,
+        tskIDLE_PRIORITY,
+        &verifierHandle);
+    completion_barrier_init(&finished, 2, verifierHandle);
+
+    start_FreeRTOS();
+}
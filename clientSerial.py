@@ -1,26 +1,163 @@
-import serial
-import serial.tools.list_ports
+import argparse
+import binascii
+import csv
+import struct
+import sys
 import time
 
-# Print all available serial ports and connect to one, y'all know there's just one open, the serial :D
-print("Available serial ports:")
-port = None
-while port is None:
-    ports = serial.tools.list_ports.comports()
-    for port in ports:
-        print(port.device, port.description)
-
-ser = serial.Serial(
-    port=port.device, 
-    baudrate=115200,
-    #timeout=5,  # Set a timeout for read operations, if triggered it just continues with the program   
-)
-
-for i in range(10):
-    print(ser.read_until(b'Enter an operation:\r\n').decode('utf-8')) #read from serial and print it
-    #time.sleep(1) # ESSENTIAL TIMEOUT, OTHERWISE MAY BLOCK. IDK WHY     D: D: D:
-    ser.write(b"10 + 3\n") # write to serial, '\n' is the end of line character to use, not '\r'
-    print(f"SENT_{i}")
-print(ser.read_until(b'Enter an operation:\r\n').decode('utf-8')) # read the final response
-
-ser.close()
+# Binary telemetry records (see include/LibraryFreeRTOS_RP2040Telemetry.h):
+# 0xA5 | len | type | payload (len bytes) | crc16 (CCITT, init 0xFFFF, of len, type and payload)
+TELEMETRY_SYNC = 0xA5
+TELEMETRY_RECORD_NAME = 0x01
+TELEMETRY_RECORD_RESULT = 0x02
+TELEMETRY_RECORD_DROPPED = 0x03
+
+TELEMETRY_KINDS = {0: "unsigned", 1: "signed", 2: "float"}
+
+CSV_COLUMNS = ["test_id", "test_name", "iteration", "core", "kind", "value", "time", "dropped"]
+
+
+def decode_value(kind, size, raw):
+    raw = raw[:size]
+    if kind == 2 and size == 4:
+        return struct.unpack("<f", raw)[0]
+    if kind == 2 and size == 8:
+        return struct.unpack("<d", raw)[0]
+    return int.from_bytes(raw, "little", signed=(kind == 1))
+
+
+def decode_telemetry(chunks):
+    """Yields one dict per record found in the byte chunks given.
+
+    Anything which is not a valid frame (text printed by the tests, corrupted bytes)
+    is skipped, resynchronizing on the next sync byte.
+    """
+    names = {}
+    buffer = bytearray()
+    for chunk in chunks:
+        buffer += chunk
+        pos = 0
+        while True:
+            pos = buffer.find(bytes([TELEMETRY_SYNC]), pos)
+            if pos < 0 or pos + 5 > len(buffer):
+                break
+            length = buffer[pos + 1]
+            if pos + length + 5 > len(buffer):
+                break   # incomplete frame, wait for more bytes
+            frame = bytes(buffer[pos + 1:pos + 3 + length])
+            crc = int.from_bytes(buffer[pos + 3 + length:pos + 5 + length], "little")
+            if binascii.crc_hqx(frame, 0xFFFF) != crc:
+                pos += 1
+                continue
+            kind, payload = frame[1], frame[2:]
+            pos += length + 5
+            if kind == TELEMETRY_RECORD_NAME:
+                test_id = int.from_bytes(payload[0:2], "little")
+                names[test_id] = payload[2:].decode("ascii", "replace")
+            elif kind == TELEMETRY_RECORD_RESULT and len(payload) == 24:
+                test_id, core, kind_size, iteration, value, elapsed = struct.unpack("<HBBI8sQ", payload)
+                value_kind, value_size = kind_size >> 4, kind_size & 0x0F
+                yield {
+                    "test_id": test_id,
+                    "test_name": names.get(test_id, ""),
+                    "iteration": iteration,
+                    "core": core,
+                    "kind": TELEMETRY_KINDS.get(value_kind, "unsigned"),
+                    "value": decode_value(value_kind, value_size, value),
+                    "time": elapsed,
+                    "dropped": 0,
+                }
+            elif kind == TELEMETRY_RECORD_DROPPED:
+                test_id, dropped = struct.unpack("<HI", payload[:6])
+                yield {
+                    "test_id": test_id,
+                    "test_name": names.get(test_id, ""),
+                    "iteration": None,
+                    "core": None,
+                    "kind": None,
+                    "value": None,
+                    "time": None,
+                    "dropped": dropped,
+                }
+        del buffer[:pos if pos >= 0 else len(buffer)]
+
+
+def read_file(path, size=4096):
+    with (sys.stdin.buffer if path == "-" else open(path, "rb")) as f:
+        while True:
+            chunk = f.read(size)
+            if not chunk:
+                return
+            yield chunk
+
+
+def read_serial(ser):
+    while True:
+        yield ser.read(max(1, ser.in_waiting))
+
+
+def write_rows(records, csv_path=None, parquet_path=None):
+    if parquet_path is not None:
+        import pandas  # only needed for Parquet (pip install pandas pyarrow)
+        pandas.DataFrame(list(records), columns=CSV_COLUMNS).to_parquet(parquet_path, index=False)
+        return
+    out = sys.stdout if csv_path is None else open(csv_path, "w", newline="")
+    writer = csv.DictWriter(out, fieldnames=CSV_COLUMNS)
+    writer.writeheader()
+    for record in records:
+        writer.writerow(record)
+        out.flush()
+    if out is not sys.stdout:
+        out.close()
+
+
+def open_serial():
+    import serial
+    import serial.tools.list_ports
+
+    # Print all available serial ports and connect to one, y'all know there's just one open, the serial :D
+    print("Available serial ports:", file=sys.stderr)
+    port = None
+    while port is None:
+        ports = serial.tools.list_ports.comports()
+        for port in ports:
+            print(port.device, port.description, file=sys.stderr)
+
+    return serial.Serial(
+        port=port.device,
+        baudrate=115200,
+        #timeout=5,  # Set a timeout for read operations, if triggered it just continues with the program
+    )
+
+
+def run_operations(ser):
+    for i in range(10):
+        print(ser.read_until(b'Enter an operation:\r\n').decode('utf-8')) #read from serial and print it
+        #time.sleep(1) # ESSENTIAL TIMEOUT, OTHERWISE MAY BLOCK. IDK WHY     D: D: D:
+        ser.write(b"10 + 3\n") # write to serial, '\n' is the end of line character to use, not '\r'
+        print(f"SENT_{i}")
+    print(ser.read_until(b'Enter an operation:\r\n').decode('utf-8')) # read the final response
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Serial client of the tests.")
+    parser.add_argument("--telemetry", action="store_true",
+                        help="decode the binary telemetry records read from the serial port")
+    parser.add_argument("--decode", metavar="FILE",
+                        help="decode the binary telemetry records of a file or pipe ('-' for stdin)")
+    parser.add_argument("--csv", metavar="FILE", help="write the rows to a CSV file instead of stdout")
+    parser.add_argument("--parquet", metavar="FILE", help="write the rows to a Parquet file (needs pandas)")
+    args = parser.parse_args()
+
+    if args.decode is not None:
+        write_rows(decode_telemetry(read_file(args.decode)), args.csv, args.parquet)
+    else:
+        ser = open_serial()
+        try:
+            if args.telemetry:
+                write_rows(decode_telemetry(read_serial(ser)), args.csv, args.parquet)
+            else:
+                run_operations(ser)
+        except KeyboardInterrupt:
+            pass
+        ser.close()
@@ -0,0 +1,77 @@
+# Host (Linux/POSIX) build of the library.
+#
+# It replaces the pico-sdk with the shims found in host/include and the RP2040 port
+# of FreeRTOS with the POSIX one, exposing the same target and function names used by
+# the CMakeLists.txt of the tests, so that they can be compiled natively unchanged.
+#
+# It should be include()ed prior to project(), in place of pico_sdk_import.cmake. After project()
+# Threads must be found and the kernel (FREERTOS_KERNEL_PATH) added with add_subdirectory().
+
+if (DEFINED ENV{FREERTOS_KERNEL_PATH} AND (NOT FREERTOS_KERNEL_PATH))
+    set(FREERTOS_KERNEL_PATH $ENV{FREERTOS_KERNEL_PATH})
+    message("Using FREERTOS_KERNEL_PATH from environment ('${FREERTOS_KERNEL_PATH}')")
+endif ()
+
+if (NOT FREERTOS_KERNEL_PATH)
+    message(FATAL_ERROR "RP2040_HOST_BUILD requires FREERTOS_KERNEL_PATH to point to a FreeRTOS-Kernel checkout")
+endif ()
+
+set(RP2040_HOST_INCLUDE_DIR ${CMAKE_CURRENT_LIST_DIR}/include)
+set(RP2040_HOST_CONFIG_DIR ${CMAKE_CURRENT_LIST_DIR}/../include)
+
+# Configuration consumed by the kernel build (FreeRTOSConfig.h is shared with the board).
+add_library(freertos_config INTERFACE)
+target_include_directories(freertos_config SYSTEM INTERFACE
+        ${RP2040_HOST_CONFIG_DIR}
+        ${RP2040_HOST_INCLUDE_DIR}
+        )
+target_compile_definitions(freertos_config INTERFACE
+        RP2040_HOST_BUILD=1
+        )
+
+# Native executables meant to be run under perf and the sanitizers,
+# e.g. -DRP2040_HOST_SANITIZE=address,undefined or -DRP2040_HOST_SANITIZE=thread.
+set(RP2040_HOST_SANITIZE "" CACHE STRING "Sanitizers enabled in the host build (-fsanitize=...)")
+add_compile_options(-g -fno-omit-frame-pointer)
+if (RP2040_HOST_SANITIZE)
+    add_compile_options(-fsanitize=${RP2040_HOST_SANITIZE})
+    add_link_options(-fsanitize=${RP2040_HOST_SANITIZE})
+endif ()
+
+set(FREERTOS_PORT GCC_POSIX CACHE STRING "" FORCE)
+# Same allocator as the board builds (FreeRTOS-Kernel-Heap1).
+set(FREERTOS_HEAP 1 CACHE STRING "" FORCE)
+
+# Targets with the names of the pico-sdk / FreeRTOS RP2040 port ones.
+add_library(FreeRTOS-Kernel INTERFACE)
+target_link_libraries(FreeRTOS-Kernel INTERFACE
+        freertos_kernel
+        freertos_config
+        Threads::Threads
+        )
+
+# The heap implementation is selected through FREERTOS_HEAP.
+add_library(FreeRTOS-Kernel-Heap1 INTERFACE)
+
+add_library(rp2040_host_shims INTERFACE)
+target_include_directories(rp2040_host_shims INTERFACE
+        ${RP2040_HOST_INCLUDE_DIR}
+        )
+target_compile_definitions(rp2040_host_shims INTERFACE
+        RP2040_HOST_BUILD=1
+        )
+
+foreach(PICO_LIBRARY pico_stdlib pico_multicore pico_rand)
+    add_library(${PICO_LIBRARY} INTERFACE)
+    target_link_libraries(${PICO_LIBRARY} INTERFACE rp2040_host_shims)
+endforeach()
+
+# pico-sdk functions used by the tests, there is nothing to do for them on the host.
+function(pico_sdk_init)
+endfunction()
+
+function(pico_add_extra_outputs TARGET)
+endfunction()
+
+function(pico_enable_stdio_usb TARGET ENABLED)
+endfunction()
@@ -0,0 +1,28 @@
+/*
+
+Host shim of hardware/claim.h.
+
+On the RP2040 hw_claim_lock() disables the interrupts and takes a hardware spin lock.
+On the host the same exclusion is given by a FreeRTOS critical section: the POSIX port
+masks the tick (so no task switch can happen) and the SMP ports also take their lock.
+
+*/
+
+#ifndef RP2040_HOST_HARDWARE_CLAIM_H
+#define RP2040_HOST_HARDWARE_CLAIM_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+static inline uint32_t hw_claim_lock(void){
+    taskENTER_CRITICAL();
+    return 0;
+}
+
+static inline void hw_claim_unlock(uint32_t save){
+    (void) save;
+    taskEXIT_CRITICAL();
+}
+
+#endif
@@ -0,0 +1,33 @@
+/*
+
+Host shim of hardware/gpio.h: there are no pins, the calls do nothing.
+
+*/
+
+#ifndef RP2040_HOST_HARDWARE_GPIO_H
+#define RP2040_HOST_HARDWARE_GPIO_H
+
+#include "pico/types.h"
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+static inline void gpio_init(uint gpio){
+    (void) gpio;
+}
+
+static inline void gpio_set_dir(uint gpio, bool out){
+    (void) gpio;
+    (void) out;
+}
+
+static inline void gpio_put(uint gpio, bool value){
+    (void) gpio;
+    (void) value;
+}
+
+static inline void gpio_xor_mask(uint32_t mask){
+    (void) mask;
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+
+Host shim of hardware/sync.h.
+
+The 32 hardware spin locks of the RP2040 are emulated with atomic flags. As on the board,
+spin_lock_blocking() also masks the interrupts of the caller (the tick of the POSIX port),
+so the task holding the lock is never switched out.
+
+*/
+
+#ifndef RP2040_HOST_HARDWARE_SYNC_H
+#define RP2040_HOST_HARDWARE_SYNC_H
+
+#include <stdbool.h>
+#include "pico/types.h"
+#include "pico/platform.h"
+#include "FreeRTOS.h"
+
+#define NUM_SPIN_LOCKS 32u
+
+typedef volatile uint32_t spin_lock_t;
+
+static inline void __dmb(void){
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __mem_fence_acquire(void){
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static inline void __mem_fence_release(void){
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static spin_lock_t host_spin_locks[NUM_SPIN_LOCKS];
+static uint32_t host_spin_locks_claimed = 0;
+
+static inline spin_lock_t *spin_lock_instance(uint lock_num){
+    return &host_spin_locks[lock_num];
+}
+
+static inline uint spin_lock_get_num(spin_lock_t *lock){
+    return (uint) (lock - host_spin_locks);
+}
+
+static inline void spin_lock_init(uint lock_num){
+    __atomic_store_n(&host_spin_locks[lock_num], 0, __ATOMIC_RELEASE);
+}
+
+static inline int spin_lock_claim_unused(bool required){
+    for(uint i=0; i<NUM_SPIN_LOCKS; ++i){
+        if(!(__atomic_fetch_or(&host_spin_locks_claimed, 1u << i, __ATOMIC_ACQ_REL) & (1u << i))){
+            return (int) i;
+        }
+    }
+    if(required){
+        panic("No spin locks are available");
+    }
+    return -1;
+}
+
+static inline void spin_lock_unclaim(uint lock_num){
+    spin_lock_init(lock_num);
+    __atomic_fetch_and(&host_spin_locks_claimed, ~(1u << lock_num), __ATOMIC_ACQ_REL);
+}
+
+/* As on the board, the striped locks are shared round-robin, never claimed. */
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16u
+#define PICO_SPINLOCK_ID_STRIPED_LAST 23u
+
+static uint host_spin_locks_striped = PICO_SPINLOCK_ID_STRIPED_FIRST;
+
+static inline uint next_striped_spin_lock_num(void){
+    uint lock_num = host_spin_locks_striped;
+    host_spin_locks_striped = lock_num == PICO_SPINLOCK_ID_STRIPED_LAST ? PICO_SPINLOCK_ID_STRIPED_FIRST : lock_num + 1;
+    return lock_num;
+}
+
+static inline void spin_lock_unsafe_blocking(spin_lock_t *lock){
+    while(__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) != 0){
+        tight_loop_contents();
+    }
+}
+
+static inline void spin_unlock_unsafe(spin_lock_t *lock){
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock){
+    portDISABLE_INTERRUPTS();
+    spin_lock_unsafe_blocking(lock);
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq){
+    (void) saved_irq;
+    spin_unlock_unsafe(lock);
+    portENABLE_INTERRUPTS();
+}
+
+#endif
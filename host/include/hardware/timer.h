@@ -0,0 +1,41 @@
+/*
+
+Host shim of hardware/timer.h, backed by CLOCK_MONOTONIC.
+
+*/
+
+#ifndef RP2040_HOST_HARDWARE_TIMER_H
+#define RP2040_HOST_HARDWARE_TIMER_H
+
+#include <time.h>
+#include "pico/types.h"
+
+static inline uint64_t time_us_64(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000u + (uint64_t) now.tv_nsec / 1000u;
+}
+
+static inline uint32_t time_us_32(void){
+    return (uint32_t) time_us_64();
+}
+
+static inline absolute_time_t get_absolute_time(void){
+    return time_us_64();
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t){
+    return t;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to){
+    return (int64_t) (to - from);
+}
+
+static inline void busy_wait_us(uint64_t delay_us){
+    uint64_t start = time_us_64();
+    while(time_us_64() - start < delay_us){
+    }
+}
+
+#endif
@@ -0,0 +1,14 @@
+/*
+
+Host shim of pico/multicore.h: the POSIX port of FreeRTOS runs one task at a time, so the cores
+are the logical ones emulated by get_core_num() (see pico/platform.h).
+
+*/
+
+#ifndef RP2040_HOST_PICO_MULTICORE_H
+#define RP2040_HOST_PICO_MULTICORE_H
+
+#include "pico/types.h"
+#include "pico/platform.h"
+
+#endif
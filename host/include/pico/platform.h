@@ -0,0 +1,52 @@
+/*
+
+Host shim of pico/platform.h.
+
+get_core_num() returns the core the calling task is running on.
+
+On an SMP port of FreeRTOS it is the one reported by portGET_CORE_ID(). The POSIX port
+runs one task at a time (configNUMBER_OF_CORES is 1 on the host), so the cores of the
+RP2040 are emulated: vTaskCoreAffinitySet() gives the task the lowest core of the mask
+as its logical core, stored in its last thread local storage pointer. The tasks never
+pinned are on core 0.
+
+*/
+
+#ifndef RP2040_HOST_PICO_PLATFORM_H
+#define RP2040_HOST_PICO_PLATFORM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "pico/types.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(portGET_CORE_ID) && (configNUMBER_OF_CORES > 1)
+#define get_core_num() ((uint) portGET_CORE_ID())
+#else
+#define RP2040_HOST_CORE_TLS_INDEX (configNUM_THREAD_LOCAL_STORAGE_POINTERS - 1)
+
+#define vTaskCoreAffinitySet(task, mask)                                                    \
+    vTaskSetThreadLocalStoragePointer((task), RP2040_HOST_CORE_TLS_INDEX,                   \
+        (void *) (uintptr_t) __builtin_ctz(mask))
+
+#define get_core_num()                                                                      \
+    ((uint) (uintptr_t) pvTaskGetThreadLocalStoragePointer(NULL, RP2040_HOST_CORE_TLS_INDEX))
+#endif
+
+static inline void panic(const char *fmt, ...){
+    va_list args;
+    va_start(args, fmt);
+    fputs("*** PANIC ***\n", stderr);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    abort();
+}
+
+static inline void tight_loop_contents(void){
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+
+Host shim of pico/rand.h: random() seeded once with the time and the pid
+(the RP2040 seeds its generator from hardware entropy at boot).
+
+*/
+
+#ifndef RP2040_HOST_PICO_RAND_H
+#define RP2040_HOST_PICO_RAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static inline uint32_t get_rand_32(void){
+    static bool seeded = false;
+    if(!seeded){
+        srandom((unsigned) time(NULL) ^ (unsigned) getpid());
+        seeded = true;
+    }
+    /* random() gives 31 bits. */
+    return ((uint32_t) random() << 16) ^ (uint32_t) random();
+}
+
+static inline uint64_t get_rand_64(void){
+    return ((uint64_t) get_rand_32() << 32) | get_rand_32();
+}
+
+#endif
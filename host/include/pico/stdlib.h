@@ -0,0 +1,35 @@
+/*
+
+Host shim of pico/stdlib.h.
+
+*/
+
+#ifndef RP2040_HOST_PICO_STDLIB_H
+#define RP2040_HOST_PICO_STDLIB_H
+
+#include <stdio.h>
+#include <time.h>
+#include "pico/types.h"
+#include "pico/platform.h"
+#include "hardware/timer.h"
+#include "hardware/gpio.h"
+
+static inline bool stdio_init_all(void){
+    /* Results are read through a pipe, do not wait for a full buffer. */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+static inline void sleep_us(uint64_t us){
+    struct timespec delay = {
+        .tv_sec = (time_t) (us / 1000000u),
+        .tv_nsec = (long) (us % 1000000u) * 1000
+    };
+    nanosleep(&delay, NULL);
+}
+
+static inline void sleep_ms(uint32_t ms){
+    sleep_us((uint64_t) ms * 1000u);
+}
+
+#endif
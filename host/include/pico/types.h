@@ -0,0 +1,19 @@
+/*
+
+Host shim of the pico-sdk types used by the library.
+
+*/
+
+#ifndef RP2040_HOST_PICO_TYPES_H
+#define RP2040_HOST_PICO_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+/* On the board it is an opaque type, here directly the microseconds since boot. */
+typedef uint64_t absolute_time_t;
+
+#endif
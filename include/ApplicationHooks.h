@@ -18,7 +18,7 @@ void vApplicationTickHook( void )
 
     "Give" the semaphore on every 500th tick interrupt. */
     ulCount++;
-    if( ulCount >= 50UL )
+    if( ulCount >= 50UL && xEventSemaphore != NULL )
     {
         /* This function is called from an interrupt context (the RTOS tick
         interrupt),    so only ISR safe API functions can be used (those that end
@@ -64,15 +64,15 @@ void vApplicationMallocFailedHook( void )
 
 void vApplicationStackOverflowHook( TaskHandle_t xTask, char *pcTaskName )
 {
-    ( void ) pcTaskName;
     ( void ) xTask;
 
     /* Run time stack overflow checking is performed if
     configconfigCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
     function is called if a stack overflow is detected.  pxCurrentTCB can be
     inspected in the debugger if the task name passed into this function is
-    corrupt. */
-    for( ;; );
+    corrupt. The high-water marks printed by the validators (stack_master,
+    stack_slave_*) tell how much stack the tasks need. */
+    panic("stack overflow in %s", pcTaskName);
 }
 /*-----------------------------------------------------------*/
 
@@ -69,7 +69,14 @@
  #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
  
  /* Memory allocation related definitions. */
+ /* Static allocation is needed by RP2040config_USE_STATIC_ALLOCATION (always built on the host,
+ where the kernel is compiled once for all the tests); the kernel provides the memory of its own tasks. */
+ #if defined(RP2040_HOST_BUILD) || (defined(RP2040config_USE_STATIC_ALLOCATION) && RP2040config_USE_STATIC_ALLOCATION)
+ #define configSUPPORT_STATIC_ALLOCATION         1
+ #define configKERNEL_PROVIDED_STATIC_MEMORY     1
+ #else
  #define configSUPPORT_STATIC_ALLOCATION         0
+ #endif
  #define configSUPPORT_DYNAMIC_ALLOCATION        1
  #define configTOTAL_HEAP_SIZE                   (128*1024)
  #define configAPPLICATION_ALLOCATED_HEAP        0
@@ -103,14 +110,27 @@
  */
  
  /* SMP port only */
+ #ifndef RP2040_HOST_BUILD
  #define configNUMBER_OF_CORES                   2
  #define configTICK_CORE                         0
  #define configRUN_MULTIPLE_PRIORITIES           1
  #define configUSE_CORE_AFFINITY                 1
+ #else
+ /* The POSIX port is not SMP (the kernel rejects the options above with a single core):
+ the two cores are emulated by host/include/pico/platform.h. */
+ #define configNUMBER_OF_CORES                   1
+ #endif
  
+ #ifndef RP2040_HOST_BUILD
  /* RP2040 specific */
  #define configSUPPORT_PICO_SYNC_INTEROP         1
  #define configSUPPORT_PICO_TIME_INTEROP         1
+ #else
+ /* POSIX port (host build): tasks run on pthread stacks which the kernel does not own,
+ so the FreeRTOS stack overflow check would only report false positives. */
+ #undef configCHECK_FOR_STACK_OVERFLOW
+ #define configCHECK_FOR_STACK_OVERFLOW          0
+ #endif
  
  #include <assert.h>
  /* Define to trap errors during development. */
@@ -136,6 +156,11 @@
  #define INCLUDE_xQueueGetMutexHolder            1
  
  /* A header file that defines trace macro can be included here. */
+ /* The scheduler events measured by RP2040config_USE_PROFILER (always traced on the host,
+ where the kernel is compiled once for all the tests). */
+ #if defined(RP2040_HOST_BUILD) || (defined(RP2040config_USE_PROFILER) && RP2040config_USE_PROFILER)
+ #include "LibraryFreeRTOS_RP2040Trace.h"
+ #endif
  
  #endif /* FREERTOS_CONFIG_H */
  
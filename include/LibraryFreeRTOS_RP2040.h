@@ -28,6 +28,28 @@ Authors:
 
 #include "FreeRTOS.h" /* Must come first. */
 #include "LibraryFreeRTOS_RP2040Config.h"
+#include "LibraryFreeRTOS_RP2040Broadcast.h"
+#include "LibraryFreeRTOS_RP2040Timing.h"
+#include "LibraryFreeRTOS_RP2040Stats.h"
+#include "LibraryFreeRTOS_RP2040Compare.h"
+#include "LibraryFreeRTOS_RP2040Retry.h"
+#include "LibraryFreeRTOS_RP2040Sharded.h"
+#include "LibraryFreeRTOS_RP2040Dmr.h"
+#include "LibraryFreeRTOS_RP2040Digest.h"
+#include "LibraryFreeRTOS_RP2040Registry.h"
+#include "LibraryFreeRTOS_RP2040Stack.h"
+#include "LibraryFreeRTOS_RP2040Transport.h"
+#include "LibraryFreeRTOS_RP2040Barrier.h"
+#include "LibraryFreeRTOS_RP2040Channel.h"
+#if RP2040config_USE_TELEMETRY
+#include "LibraryFreeRTOS_RP2040Telemetry.h"
+#endif
+#if RP2040config_USE_FAULT_INJECTION
+#include "LibraryFreeRTOS_RP2040Fault.h"
+#endif
+#if RP2040config_USE_PROFILER
+#include "LibraryFreeRTOS_RP2040Profiler.h"
+#endif
 #include "task.h"     /* RTOS task related API prototypes. */
 #include "semphr.h"   /* Semaphore related API prototypes. */
 #include <stdio.h>
@@ -51,20 +73,21 @@ Authors:
 
 /*
     Macro used to store in an internal variable the time read 
-    from the internal hw timer of the RP2040.
+    from the timing backend (see LibraryFreeRTOS_RP2040Timing.h).
 */
 
 #define save_time_now()                                 \
-absolute_time_t saved_time = get_absolute_time()        \
+timing_stamp_t saved_time = timing_now()                \
 
 /*
     Macro callable only after "save_time_now()".
     It returns the difference between the instant of time saved before
-    and the current time as a uint64_t value.
+    and the current time as a uint64_t value, in RP2040_TIME_UNIT,
+    without the calibrated overhead of the measurement.
 */
 
 #define calc_time_diff()                                \
-absolute_time_diff_us(saved_time,get_absolute_time())   \
+timing_elapsed(saved_time)                              \
 
 
 /*
@@ -93,10 +116,503 @@ absolute_time_diff_us(saved_time,get_absolute_time())   \
     Macro used to define the default behavior of the master function
     when the check_function is not cutomized.
 
-    It simply returns the negated XOR of the two return values (so if they are the same).
+    It compares the two return values according to their type (see GENERIC_CHECK in
+    LibraryFreeRTOS_RP2040Compare.h): float and double as set by RP2040config_CHECK_FLOAT,
+    integers and structures bitwise.
 */
 #define DEFAULT_CHECK(return_val_0, return_val_1)                                                        \
-    !(return_val_0 ^ return_val_1)                                                                       \
+    GENERIC_CHECK(return_val_0, return_val_1)                                                            \
+
+/*
+    Macros used to keep the size of the differences between the results compared
+    (see CHECK_ERROR), printed by PRINT_CHECK_ERRORS.
+*/
+
+#define DECLARE_CHECK_ERRORS(test_name)                                                                \
+static struct check_errors check_errors_##test_name;                                                   \
+
+#define ADD_CHECK_ERROR(test_name, value, expected)                                                    \
+    check_errors_add(&check_errors_##test_name, CHECK_ERROR(value, expected),                          \
+        CHECK_ERROR_UNIT(value));                                                                      \
+
+#define ADD_CHECK_ERRORS(test_name, variables)                                                         \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES-1; i++){                                              \
+        ADD_CHECK_ERROR(test_name, variables[i].return_value, variables[i+1].return_value)             \
+    }                                                                                                  \
+
+#define PRINT_CHECK_ERRORS(test_name)                                                                  \
+    check_errors_print(STRING(test_name), &check_errors_##test_name);                                  \
+
+/*
+    Macro used to print the cost of dispatching the slaves, measured by the master.
+
+    dispatch_time_avg is the mean round-trip (wake up the slaves, run, wait all of them)
+    over the dispatch_count executions of the test, while dispatch_overhead is the part of
+    the last round-trip which was not spent executing the function on the slowest core.
+*/
+
+#define PRINT_DISPATCH_STATS(test_name, dispatch_count, dispatch_time_total, dispatch_time)              \
+    {                                                                                                    \
+        uint64_t slowest_core = 0;                                                                       \
+        for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+            if(return_info_##test_name[i].return_time > slowest_core){                                   \
+                slowest_core = return_info_##test_name[i].return_time;                                   \
+            }                                                                                            \
+        }                                                                                                \
+        printf(STRING(test_name)"> dispatch_count:\t %lu \n", (unsigned long) (dispatch_count));         \
+        printf(STRING(test_name)"> dispatch_time_avg:\t %llu " RP2040_TIME_UNIT "\n",                    \
+            (unsigned long long) ((dispatch_time_total)/(dispatch_count)));                              \
+        printf(STRING(test_name)"> dispatch_overhead:\t %llu " RP2040_TIME_UNIT "\n",                    \
+            (unsigned long long) ((dispatch_time) > slowest_core ? (dispatch_time) - slowest_core : 0)); \
+    }                                                                                                    \
+
+/*
+    Macros used to collect and print the statistics of return_time over the timed runs
+    (see LibraryFreeRTOS_RP2040Stats.h), one run_stats per core.
+
+    PRINT_RUN_STATS prints the value returned by each core in the last run, followed by
+    min, median, mean, p99, max and standard deviation of its return_time.
+*/
+
+#define ADD_RUN_STATS(test_name, run)                                                                \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+        run_stats_add(&run_stats_##test_name[i], return_info_##test_name[i].return_time);            \
+        EMIT_RESULT(test_name, run, i, return_info_##test_name[i])                                   \
+    }                                                                                                \
+
+#define PRINT_RUN_STATS(test_name, conversion_char)                                                  \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+        printf(                                                                                      \
+            STRING(test_name)"> return_core_%d:\t" conversion_char"\n",                              \
+            i,  return_info_##test_name[i].return_value);                                            \
+        run_stats_print(STRING(test_name), i, &run_stats_##test_name[i], RP2040_TIME_UNIT);          \
+    }                                                                                                \
+
+/*
+    Macros applying the retry policy of a test (see LibraryFreeRTOS_RP2040Retry.h).
+
+    RETRY_AFTER_MISMATCH is called by the master after a failed attempt: it gives up the run
+    (breaking the retry loop) when the attempts are exhausted, otherwise it sleeps for the backoff.
+*/
+
+#define RETRY_AFTER_MISMATCH(test_name, run, attempts, attempt_time)                                 \
+    retry_stats_##test_name.wasted_time += (attempt_time);                                           \
+    if(retry_exhausted(&retry_policy_##test_name, (attempts))){                                      \
+        retry_stats_##test_name.failed_runs++;                                                       \
+        printf(STRING(test_name)"> check_result: RETRIES_EXHAUSTED\n");                              \
+        if(retry_policy_##test_name.escalation != NULL){                                             \
+            retry_policy_##test_name.escalation(STRING(test_name), (run), (attempts));               \
+        }                                                                                            \
+        break;                                                                                       \
+    } else {                                                                                         \
+        TickType_t backoff = retry_backoff(&retry_policy_##test_name, (attempts));                   \
+        retry_stats_##test_name.backoff_ticks += backoff;                                            \
+        if(backoff > 0){                                                                             \
+            vTaskDelay(backoff);                                                                     \
+        }                                                                                            \
+    }                                                                                                \
+
+#define PRINT_RETRY_STATS(test_name)                                                                 \
+    printf(STRING(test_name)"> retries:\t %lu \n", (unsigned long) retry_stats_##test_name.retries); \
+    printf(STRING(test_name)"> failed_runs:\t %lu \n",                                               \
+        (unsigned long) retry_stats_##test_name.failed_runs);                                        \
+    printf(STRING(test_name)"> retry_time_wasted:\t %llu " RP2040_TIME_UNIT "\n",                    \
+        (unsigned long long) retry_stats_##test_name.wasted_time);                                   \
+    printf(STRING(test_name)"> retry_backoff:\t %lu ticks\n",                                        \
+        (unsigned long) retry_stats_##test_name.backoff_ticks);                                      \
+
+/*
+    Changes the retry policy of a test, before its master is started.
+*/
+#define configure_retry(test_name, max_attempts_, backoff_ticks_, backoff_max_ticks_, escalation_)   \
+    retry_policy_##test_name.max_attempts = (max_attempts_);                                         \
+    retry_policy_##test_name.backoff_ticks = (backoff_ticks_);                                       \
+    retry_policy_##test_name.backoff_max_ticks = (backoff_max_ticks_);                               \
+    retry_policy_##test_name.escalation = (escalation_);                                             \
+
+/*
+    Prints the stack used by the master (the calling task) and by the n_slaves slaves of a test
+    (see LibraryFreeRTOS_RP2040Stack.h), slave_free being the high-water mark of slave i.
+*/
+
+#define PRINT_STACK_STATS(test_name, n_slaves, slave_free)                                           \
+    {                                                                                                \
+        UBaseType_t stack_free[n_slaves];                                                            \
+        for(uint32_t i=0; i<(uint32_t) (n_slaves); ++i){                                             \
+            stack_free[i] = (slave_free);                                                            \
+        }                                                                                            \
+        stack_report(STRING(test_name), STACK_MASTER_SIZE(test_name), uxTaskGetStackHighWaterMark(NULL),\
+            STACK_SLAVE_SIZE(test_name), stack_free, (n_slaves));                                    \
+    }                                                                                                \
+
+/*
+    Macros injecting faults in the validators (see LibraryFreeRTOS_RP2040Fault.h).
+
+    FAULT_PLAN draws the fault of the next attempt among the kinds enabled for the test,
+    FAULT_FLIP applies it to a value of a core (the slaves flip their own result, before
+    publishing it) and FAULT_RECORD classifies the attempt after the check. Without RP2040config_USE_FAULT_INJECTION they do nothing.
+*/
+
+#if RP2040config_USE_FAULT_INJECTION
+
+#define DECLARE_FAULTS(test_name)                                                                    \
+static struct fault_plan fault_plan_##test_name = FAULT_PLAN_INIT;                                   \
+static struct fault_stats fault_stats_##test_name;                                                   \
+static uint32_t fault_kinds_##test_name = RP2040config_FAULT_KINDS;                                  \
+
+#define FAULT_PLAN(test_name, allowed_kinds)                                                         \
+    fault_plan_next(&fault_plan_##test_name, fault_kinds_##test_name & (allowed_kinds));             \
+
+#define FAULT_DELAY(test_name, core)                                                                 \
+    fault_delay(&fault_plan_##test_name, (core));                                                    \
+
+#define FAULT_FLIP(test_name, kind, core, lvalue)                                                    \
+    fault_flip(&fault_plan_##test_name, (kind), (core), &(lvalue), sizeof(lvalue));                  \
+
+#define FAULT_RECORD(test_name, check_result)                                                        \
+    fault_record(&fault_stats_##test_name, &fault_plan_##test_name, (check_result));                 \
+
+#define PRINT_FAULT_STATS(test_name)                                                                 \
+    fault_stats_print(STRING(test_name), &fault_stats_##test_name);                                  \
+
+/*
+    Changes the kinds of faults injected in a test, their rate (in parts per million)
+    and the seed of its PRNG, before its master is started.
+*/
+#define configure_faults(test_name, kinds, rate, seed)                                               \
+    fault_kinds_##test_name = (kinds);                                                               \
+    fault_plan_##test_name.rate_ppm = (rate);                                                        \
+    fault_seed(&fault_plan_##test_name, (seed));                                                     \
+
+#else
+
+#define DECLARE_FAULTS(test_name)
+#define FAULT_PLAN(test_name, allowed_kinds)
+#define FAULT_DELAY(test_name, core)
+#define FAULT_FLIP(test_name, kind, core, lvalue)
+#define FAULT_RECORD(test_name, check_result)
+#define PRINT_FAULT_STATS(test_name)
+#define configure_faults(test_name, kinds, rate, seed)
+
+#endif
+
+/*
+    Macros used by the masters to report the results of the slaves.
+
+    With RP2040config_USE_TELEMETRY every result is a binary record written in the ring
+    of the test (see LibraryFreeRTOS_RP2040Telemetry.h), otherwise the results of the
+    task validator are printed and EMIT_RESULT does nothing (the function validators
+    print their statistics at the end anyway). The results of a test whose ring could not be
+    registered are printed as well.
+*/
+
+#define PRINT_SLAVE_RESULT(test_name, core, conversion_char)                                         \
+    printf(                                                                                          \
+        STRING(test_name)"> return_core_id__core:\t %d\n",                                           \
+        core);                                                                                       \
+    printf(                                                                                          \
+        STRING(test_name)"> return_value_core_%d:\t" conversion_char"\n",                            \
+        core, return_info_slaves_##test_name[core].return_value);                                    \
+    printf(                                                                                          \
+        STRING(test_name)"> return_time__core_%d:\t%llu " RP2040_TIME_UNIT "\n\n",                   \
+        core, (unsigned long long) return_info_slaves_##test_name[core].return_time);                \
+
+#if RP2040config_USE_TELEMETRY
+
+#define DECLARE_TELEMETRY(test_name)                                                                 \
+static struct telemetry_ring telemetry_ring_##test_name;                                             \
+
+#define REGISTER_TELEMETRY(test_name)                                                                \
+telemetry_register(&telemetry_ring_##test_name, STRING(test_name));                                  \
+
+#define WAIT_TELEMETRY(test_name)                                                                    \
+    telemetry_flush_dropped(&telemetry_ring_##test_name);                                            \
+    telemetry_wait_drained(&telemetry_ring_##test_name);                                             \
+
+#define EMIT_RESULT(test_name, iteration, core, info)                                                \
+    telemetry_emit_result(&telemetry_ring_##test_name, (iteration), (core),                          \
+        TELEMETRY_KIND((info).return_value), &(info).return_value, sizeof((info).return_value),      \
+        (info).return_time);                                                                         \
+
+#define REPORT_SLAVE_RESULT(test_name, iteration, core, conversion_char)                             \
+    if(telemetry_ring_##test_name.disabled){    /* Not registered (see telemetry_register). */       \
+        PRINT_SLAVE_RESULT(test_name, core, conversion_char)                                         \
+    } else {                                                                                         \
+        EMIT_RESULT(test_name, iteration, core, return_info_slaves_##test_name[core])                \
+    }                                                                                                \
+
+#else
+
+#define DECLARE_TELEMETRY(test_name)
+#define REGISTER_TELEMETRY(test_name)
+#define WAIT_TELEMETRY(test_name)
+#define EMIT_RESULT(test_name, iteration, core, info)
+
+#define REPORT_SLAVE_RESULT(test_name, iteration, core, conversion_char)                             \
+    PRINT_SLAVE_RESULT(test_name, core, conversion_char)                                             \
+
+#endif
+
+// ------------------------------------------------------------------------ //
+//  TASK ALLOCATION                                                         //
+// ------------------------------------------------------------------------ //
+
+/*
+    Storage of the tasks created by the library.
+
+    With RP2040config_USE_STATIC_ALLOCATION the stack and the TCB of every task are declared
+    statically next to the test (DECLARE_TASK_STORAGE) and the tasks are created with
+    xTaskCreateStatic, so the validators do not allocate anything from the FreeRTOS heap and
+    their RAM is known at link time. Otherwise DECLARE_TASK_STORAGE declares nothing,
+    TASK_STORAGE passes NULL and the tasks are allocated in the heap.
+*/
+
+#if RP2040config_USE_STATIC_ALLOCATION
+
+#define DECLARE_TASK_STORAGE(name, count, stack_size)                                                \
+static struct{                                                                                       \
+    StackType_t stacks[count][stack_size];                                                           \
+    StaticTask_t tcbs[count];                                                                        \
+} name;                                                                                              \
+
+#define TASK_STORAGE(storage, i) (storage).stacks[i], &(storage).tcbs[i]
+#define TASK_STORAGE_ALL(storage) &(storage).stacks[0][0], (storage).tcbs
+
+#else
+
+#define DECLARE_TASK_STORAGE(name, count, stack_size)
+#define TASK_STORAGE(storage, i) NULL, NULL
+#define TASK_STORAGE_ALL(storage) NULL, NULL
+
+#endif
+
+/*
+    Creates a task in the storage given (see TASK_STORAGE) and writes its handle in *handle
+    before the task can run, since the tasks created may signal each other through the handle
+    as soon as they start: xTaskCreate writes it before the task is made ready, while
+    xTaskCreateStatic returns it, so the scheduler is suspended around it.
+    *handle is NULL if the task cannot be created (heap exhausted).
+*/
+
+static inline void create_task(TaskFunction_t function, const char *name, uint32_t stack_size, void *param, UBaseType_t priority, TaskHandle_t *handle, StackType_t *stack, StaticTask_t *tcb){
+#if RP2040config_USE_STATIC_ALLOCATION
+    vTaskSuspendAll();
+    *handle = xTaskCreateStatic(function, name, stack_size, param, priority, stack, tcb);
+    xTaskResumeAll();
+#else
+    (void) stack;
+    (void) tcb;
+    if(xTaskCreate(function, name, stack_size, param, priority, handle) != pdPASS){
+        *handle = NULL;
+    }
+#endif
+}
+
+// ------------------------------------------------------------------------ //
+//  WORKER POOL                                                             //
+// ------------------------------------------------------------------------ //
+
+/*
+    Set of slave tasks (one per core) used by the function validators.
+
+    With RP2040config_USE_WORKER_POOL the workers are created once, pinned to their core
+    and then wait for the master: a dispatch costs one signal per core.
+    Otherwise every dispatch creates the slaves and deletes them after the job,
+    which puts the heap allocation, TCB setup and stack painting on the hot path.
+
+    The master dispatches the workers through transports (see LibraryFreeRTOS_RP2040Transport.h),
+    task notifications unless RP2040config_TRANSPORT says otherwise, and waits for them on a
+    completion barrier (see LibraryFreeRTOS_RP2040Barrier.h), woken up once per dispatch.
+*/
+
+typedef void (*worker_job_t)(void *job_param);
+
+struct worker_pool;
+
+struct worker_info{
+    struct worker_pool *pool;
+    void *job_param;
+    TaskHandle_t handle;
+    struct transport dispatch;  /* From the master to the worker. */
+    UBaseType_t stack_free;     /* High-water mark of the worker, in words. */
+};
+
+struct worker_pool{
+    struct worker_info workers[RP2040config_testRUN_ON_CORES];
+    uint32_t stack_size;
+    StackType_t *stacks;        /* RP2040config_testRUN_ON_CORES stacks of stack_size words, if static. */
+    StaticTask_t *tcbs;
+    const char *name;
+    worker_job_t job;
+    TaskHandle_t master;
+    struct completion_barrier done;
+    bool running;
+};
+
+#if RP2040config_USE_WORKER_POOL
+
+/*
+    Body of a persistent worker: it runs the job of the pool every time it is notified,
+    until the pool is stopped.
+*/
+
+static void vWorkerFunction(void *pvParameters){
+    struct worker_info *worker = (struct worker_info *) pvParameters;
+    while(true){
+        transport_wait(&worker->dispatch);  /* Wait for the master to dispatch. */
+        if(!worker->pool->running){
+            break;
+        }
+        worker->pool->job(worker->job_param);
+        completion_barrier_arrive(&worker->pool->done);
+    }
+    worker->stack_free = uxTaskGetStackHighWaterMark(NULL);
+    completion_barrier_arrive(&worker->pool->done);
+    vTaskDelete(NULL);
+}
+
+#else
+
+/*
+    Body of a worker created for a single dispatch.
+*/
+
+static void vEphemeralWorkerFunction(void *pvParameters){
+    struct worker_info *worker = (struct worker_info *) pvParameters;
+    worker->pool->job(worker->job_param);
+    worker->stack_free = stack_free_min(worker->stack_free, uxTaskGetStackHighWaterMark(NULL));
+    completion_barrier_arrive(&worker->pool->done);
+    vTaskDelete(NULL);
+}
+
+#endif
+
+/*
+    Creates a task pinned to the given core, with a stack of stack_size words in the storage given
+    (see TASK_STORAGE).
+    The scheduler is suspended so that the task cannot start on the wrong core.
+    It returns false if the task cannot be created (heap exhausted): the handle is then NULL,
+    and no affinity is set (with a NULL handle it would pin the calling task).
+*/
+
+static inline bool create_pinned_task(TaskFunction_t function, const char *name, void *param, int core, uint32_t stack_size, TaskHandle_t *handle, StackType_t *stack, StaticTask_t *tcb){
+    vTaskSuspendAll();
+    create_task(function,
+        name,
+        stack_size,
+        param,
+        RP2040config_tskSLAVE_PRIORITY,
+        handle,
+        stack,
+        tcb);
+    if(*handle != NULL){
+        vTaskCoreAffinitySet(*handle, (1 << core));
+    }
+    xTaskResumeAll();
+    return *handle != NULL;
+}
+
+/*
+    Sets the stack of the workers, before worker_pool_start: stacks and tcbs (TASK_STORAGE_ALL)
+    hold one stack of stack_size words and one TCB per core, NULL with dynamic allocation.
+    Without it the workers get RP2040config_tskSLAVE_STACK_SIZE words from the heap.
+*/
+
+static inline void worker_pool_storage(struct worker_pool *pool, uint32_t stack_size, StackType_t *stacks, StaticTask_t *tcbs){
+    pool->stack_size = stack_size;
+    pool->stacks = stacks;
+    pool->tcbs = tcbs;
+}
+
+/*
+    Stack of worker i in the storage of the pool (see worker_pool_storage).
+*/
+#define WORKER_STORAGE(pool, i) \
+    ((pool)->stacks != NULL ? (pool)->stacks + (i)*(pool)->stack_size : NULL), \
+    ((pool)->tcbs != NULL ? &(pool)->tcbs[i] : NULL)
+
+/*
+    Binds the pool to the calling (master) task and to its job.
+
+    params points to an array of RP2040config_testRUN_ON_CORES elements of param_size bytes,
+    the i-th element is passed to the job running on core i.
+*/
+
+static inline void worker_pool_start(struct worker_pool *pool, const char *name, worker_job_t job, void *params, size_t param_size){
+    pool->name = name;
+    pool->job = job;
+    pool->master = xTaskGetCurrentTaskHandle();
+    pool->running = true;
+    if(pool->stack_size == 0){
+        pool->stack_size = RP2040config_tskSLAVE_STACK_SIZE;
+    }
+    completion_barrier_init(&pool->done, RP2040config_testRUN_ON_CORES, pool->master);
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        pool->workers[i].pool = pool;
+        pool->workers[i].job_param = (char *) params + i*param_size;
+        pool->workers[i].stack_free = STACK_FREE_UNKNOWN;
+#if RP2040config_USE_WORKER_POOL
+        transport_init(&pool->workers[i].dispatch, NULL);   /* The worker may wait before it is bound. */
+        bool created = create_pinned_task(vWorkerFunction, name, &pool->workers[i], i, pool->stack_size,
+            &pool->workers[i].handle, WORKER_STORAGE(pool, i));
+        configASSERT(created);      /* Otherwise the master would wait for it forever. */
+        (void) created;
+        transport_bind(&pool->workers[i].dispatch, pool->workers[i].handle);
+#endif
+    }
+}
+
+/*
+    Runs the job once on every core.
+*/
+
+static inline void worker_pool_dispatch(struct worker_pool *pool){
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+#if RP2040config_USE_WORKER_POOL
+        transport_signal(&pool->workers[i].dispatch);
+#else
+        /* With heap_1 the memory of the deleted workers is never freed: every dispatch leaks
+           two stacks and TCBs, until the creation fails. */
+        bool created = create_pinned_task(vEphemeralWorkerFunction, pool->name, &pool->workers[i], i,
+            pool->stack_size, &pool->workers[i].handle, NULL, NULL);
+        if(!created){
+            printf("%s> worker_create_failed:\t core %d \n", pool->name, i);
+        }
+        configASSERT(created);
+        (void) created;
+#endif
+    }
+}
+
+/*
+    Blocks the master until every core has completed the dispatched job.
+*/
+
+static inline void worker_pool_wait(struct worker_pool *pool){
+    completion_barrier_wait(&pool->done);
+}
+
+/*
+    Terminates the persistent workers (if any) and waits for them to exit.
+*/
+
+static inline void worker_pool_stop(struct worker_pool *pool){
+    pool->running = false;
+#if RP2040config_USE_WORKER_POOL
+    worker_pool_dispatch(pool);
+    worker_pool_wait(pool);
+#endif
+}
+
+/*
+    Counters of the pipelined mode of create_multicore_task_validator, written by the master only.
+*/
+
+struct pipeline_state{
+    uint32_t submitted;         /* Iterations submitted to the slaves. */
+    uint32_t collected;         /* Iterations collected by the master. */
+    uint32_t taken;             /* Notifications taken for the completions of the pipelined inputs. */
+};
 
 // ------------------------------------------------------------------------ //
 //  PUBLIC INTERFACE                                                        //
@@ -125,6 +641,12 @@ void start_hw(){
 */
 
 void start_FreeRTOS(){
+#if RP2040config_USE_TELEMETRY
+    telemetry_start();  /* Drain task of the results of the masters. */
+#endif
+#if RP2040config_USE_PROFILER
+    profiler_start();   /* Task printing the profile of the cores and of the tasks. */
+#endif
     vTaskStartScheduler();
 }
 
@@ -148,6 +670,14 @@ void start_FreeRTOS(){
     1 master task, which creates the two slaves, assigns and schedules them.
     Then it will pause until both tasks are finished and it prints the result on the serial port.
 
+    The slaves belong to a worker pool (see WORKER POOL): they are created once and reused
+    by every retry of the test, together with the time spent by the master to dispatch them.
+
+    The test is executed RP2040config_testWARMUP_RUNS + RP2040config_testREPEAT_RUNS times
+    (each one retried while the cores disagree, following the retry policy of the test, see
+    configure_retry) and the statistics of return_time are computed over the timed runs
+    which ended with the cores agreeing.
+
     For the moment it is assumed that the type returned by the task is a simple type.
 
     At the end all the values produced by each core will be compared, expecting them to be all equal. 
@@ -156,53 +686,293 @@ void start_FreeRTOS(){
 
 #define create_multicore_function_validator(test_name, return_type, conversion_char, function_name, check_function, ...)          \
 static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
                                                                                                             \
 struct return_info_##test_name{                                                                             \
     return_type return_value;                                                                               \
     uint64_t    return_time;                                                                                \
 };                                                                                                          \
 static struct return_info_##test_name return_info_##test_name[RP2040config_testRUN_ON_CORES];               \
+static struct worker_pool worker_pool_##test_name;                                                          \
+DECLARE_TASK_STORAGE(worker_storage_##test_name,                                                            \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static struct run_stats run_stats_##test_name[RP2040config_testRUN_ON_CORES];                               \
+static struct retry_policy retry_policy_##test_name = RETRY_POLICY_DEFAULT;                                 \
+static struct retry_stats retry_stats_##test_name;                                                          \
+DECLARE_TELEMETRY(test_name)                                                                                \
+DECLARE_FAULTS(test_name)                                                                                   \
+DECLARE_CHECK_ERRORS(test_name)                                                                             \
                                                                                                             \
 static void vSlaveFunction_##test_name(void *pvParameters){                                                 \
     save_time_now();                                                                                        \
+    FAULT_DELAY(test_name, get_core_num())                                                                  \
     ((struct return_info_##test_name *) pvParameters)->return_value=function_name(__VA_ARGS__);             \
     ((struct return_info_##test_name *) pvParameters)->return_time=calc_time_diff();                        \
-    xTaskNotifyGive(masterTaskHandle_##test_name);                                                          \
-    vTaskDelete(NULL);                                                                                      \
+    FAULT_FLIP(test_name, FAULT_FLIP_RESULT, get_core_num(),                                                \
+        ((struct return_info_##test_name *) pvParameters)->return_value)                                    \
 }                                                                                                           \
                                                                                                             \
 static void vMasterFunction_##test_name() {                                                                 \
     bool check_result = false;                                                                              \
-    while(!check_result){                                                                                   \
-        TaskHandle_t vSlaveFunctionHandles[RP2040config_testRUN_ON_CORES];                                  \
-        for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                  \
-            xTaskCreate(vSlaveFunction_##test_name,                                                         \
-                STRING(vSlaveFunction_##test_name)STRING(n),                                                \
-                RP2040config_tskSLAVE_STACK_SIZE,                                                           \
-                &return_info_##test_name[i],                                                                \
-                RP2040config_tskSLAVE_PRIORITY,                                                             \
-                &vSlaveFunctionHandles[i]);                                                                 \
-            vTaskCoreAffinitySet(vSlaveFunctionHandles[i], (1 << i));                                       \
-        }                                                                                                   \
-        for (int i = 0; i<RP2040config_testRUN_ON_CORES; i++) {                                             \
-            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                                       \
+    uint32_t dispatch_count = 0;                                                                            \
+    uint64_t dispatch_time = 0;                                                                             \
+    uint64_t dispatch_time_total = 0;                                                                       \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
+        run_stats_init(&run_stats_##test_name[i]);                                                          \
+    }                                                                                                       \
+    retry_stats_init(&retry_stats_##test_name);                                                             \
+    worker_pool_storage(&worker_pool_##test_name, STACK_SLAVE_SIZE(test_name),                              \
+        TASK_STORAGE_ALL(worker_storage_##test_name));                                                      \
+    worker_pool_start(&worker_pool_##test_name,                                                             \
+        STRING(vSlaveFunction_##test_name)STRING(n),                                                        \
+        vSlaveFunction_##test_name,                                                                         \
+        return_info_##test_name,                                                                            \
+        sizeof(return_info_##test_name[0]));                                                                \
+    for(int run=0; run<RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS; ++run){                   \
+        uint32_t attempts = 0;                                                                              \
+        check_result = false;                                                                               \
+        while(!check_result){                                                                               \
+            FAULT_PLAN(test_name, ~FAULT_CORRUPT_INPUT)  /* The arguments are constants. */                 \
+            {                                                                                               \
+                save_time_now();                                                                            \
+                worker_pool_dispatch(&worker_pool_##test_name);                                             \
+                worker_pool_wait(&worker_pool_##test_name);                                                 \
+                dispatch_time=calc_time_diff();                                                             \
+            }                                                                                               \
+            dispatch_count++;                                                                               \
+            dispatch_time_total+=dispatch_time;                                                             \
+            attempts++;                                                                                     \
+            CHECK_GENERATION(check_function, return_info_##test_name)                                       \
+            ADD_CHECK_ERRORS(test_name, return_info_##test_name)                                            \
+            FAULT_RECORD(test_name, check_result)                                                           \
+            if(!check_result){                                                                              \
+                printf(STRING(test_name)"> check_result: NOT_EQUALS\n");                                    \
+                RETRY_AFTER_MISMATCH(test_name, run, attempts, dispatch_time)                               \
+            }                                                                                               \
         }                                                                                                   \
-        CHECK_GENERATION(check_function, return_info_##test_name)                                           \
-        if(!check_result){                                                                                  \
-            printf(STRING(test_name)"> check_result: NOT_EQUALS\n");                                        \
+        retry_stats_##test_name.retries += attempts - 1;                                                    \
+        if(check_result && run >= RP2040config_testWARMUP_RUNS){                                            \
+            ADD_RUN_STATS(test_name, run - RP2040config_testWARMUP_RUNS)                                    \
         }                                                                                                   \
     }                                                                                                       \
+    worker_pool_stop(&worker_pool_##test_name);                                                             \
     printf(STRING(test_name)" has ended correctly!\n");                                                     \
-    for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
-        printf(                                                                                             \
-            STRING(test_name)"> return_core_%d:\t" conversion_char"\n",                                     \
-            i,  return_info_##test_name[i].return_value);                                                   \
-        printf(                                                                                             \
-            STRING(test_name)"> return_time_%d:\t %llu \n",                                                 \
-            i,  return_info_##test_name[i].return_time);                                                    \
+    PRINT_RUN_STATS(test_name, conversion_char)                                                             \
+    PRINT_DISPATCH_STATS(test_name, dispatch_count, dispatch_time_total, dispatch_time)                     \
+    PRINT_CHECK_ERRORS(test_name)                                                                           \
+    PRINT_RETRY_STATS(test_name)                                                                            \
+    PRINT_FAULT_STATS(test_name)                                                                            \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        worker_pool_##test_name.workers[i].stack_free)                                                      \
+    test_finished(&test_state_##test_name);                                                                 \
+    vTaskDelete(NULL);                                                                                      \
+}                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/*
+    Voters of create_nmr_function_validator, one is defined for each test by NMR_DEFINE_VOTER.
+    majority returns the value returned by more than half of the replicas (compared with
+    GENERIC_CHECK), false if there is none; median the middle of the sorted values (the lower
+    one for an even number), and needs return_type to be ordered with <.
+*/
+#define NMR_DEFINE_majority(test_name, return_type, n_replicas)                                             \
+static bool nmr_majority_##test_name(return_type *voted){                                                   \
+    uint32_t best = 0, best_count = 0;                                                                      \
+    for(uint32_t i=0; i<(n_replicas); ++i){                                                                 \
+        uint32_t count = 0;                                                                                 \
+        for(uint32_t j=0; j<(n_replicas); ++j){                                                             \
+            count += GENERIC_CHECK(return_info_##test_name[i].return_value,                                 \
+                return_info_##test_name[j].return_value);                                                   \
+        }                                                                                                   \
+        if(count > best_count){                                                                             \
+            best = i;                                                                                       \
+            best_count = count;                                                                             \
+        }                                                                                                   \
+    }                                                                                                       \
+    *voted = return_info_##test_name[best].return_value;                                                    \
+    return 2*best_count > (n_replicas);                                                                     \
+}                                                                                                           \
+
+#define NMR_DEFINE_median(test_name, return_type, n_replicas)                                               \
+static bool nmr_median_##test_name(return_type *voted){                                                     \
+    return_type sorted[n_replicas];                                                                         \
+    for(uint32_t i=0; i<(n_replicas); ++i){                                                                 \
+        return_type value = return_info_##test_name[i].return_value;                                        \
+        uint32_t j = i;                                                                                     \
+        for(; j>0 && value < sorted[j-1]; --j){                                                             \
+            sorted[j] = sorted[j-1];                                                                        \
+        }                                                                                                   \
+        sorted[j] = value;                                                                                  \
+    }                                                                                                       \
+    *voted = sorted[((n_replicas) - 1)/2];                                                                  \
+    return true;                                                                                            \
+}                                                                                                           \
+
+/**
+    Macro which creates the testing pipeline for non-void functions executed by N replicas
+    (N-modular redundancy).
+
+    Arguments:
+
+        - test_name         : unique identifier of the test name
+        - return_type       : return value of the function.
+        - conversion_char   : identifier to convert the result of the function in a string (e.g. int32_t -> "%d").
+        - function_name     : name of the function to be called.
+        - n_replicas        : number of replicas, also more than RP2040config_testRUN_ON_CORES.
+        - voter             : majority (the value returned by more than half of the replicas)
+                              or median (the middle of the sorted values, needs return_type to be ordered).
+        - ...               : arguments passed as inputs to the function.
+
+    Every replica is a task pinned to core (replica % RP2040config_testRUN_ON_CORES), so the replicas
+    of the same core are time-multiplexed. They are created once and woken up by a notification at every run.
+    Inside the function nmr_replica_id() gives the index of the replica running it.
+
+    At every run the voted value is computed, and every replica whose value differs from it
+    gets a disagreement. The values are compared with GENERIC_CHECK (see
+    LibraryFreeRTOS_RP2040Compare.h), so return_type can also be a float or (with majority) a structure,
+    and the difference of every replica from the voted value is kept as a check error.
+    With majority a run without a majority is reported as NO_MAJORITY.
+
+    The voted value, the disagreements of every replica, the statistics of the time of a vote
+    (dispatch, execution of all the replicas and vote) and the votes per second are printed at the end.
+ */
+
+#define create_nmr_function_validator(test_name, return_type, conversion_char, function_name, n_replicas, voter, ...)          \
+static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
+                                                                                                            \
+struct return_info_##test_name{                                                                             \
+    uint32_t replica;                                                                                       \
+    TaskHandle_t handle;                                                                                    \
+    UBaseType_t stack_free;                                                                                 \
+    return_type return_value;                                                                               \
+    uint64_t    return_time;                                                                                \
+};                                                                                                          \
+static struct return_info_##test_name return_info_##test_name[n_replicas];                                  \
+static uint32_t nmr_disagreements_##test_name[n_replicas];                                                  \
+DECLARE_TASK_STORAGE(replica_storage_##test_name, n_replicas, STACK_SLAVE_SIZE(test_name))                  \
+static bool nmr_running_##test_name = true;                                                                 \
+static struct completion_barrier replicas_done_##test_name;                                                 \
+DECLARE_TELEMETRY(test_name)                                                                                \
+DECLARE_CHECK_ERRORS(test_name)                                                                             \
+                                                                                                            \
+NMR_DEFINE_VOTER(voter, test_name, return_type, n_replicas)                                                 \
+                                                                                                            \
+static void vReplicaFunction_##test_name(void *pvParameters){                                               \
+    struct return_info_##test_name *info = (struct return_info_##test_name *) pvParameters;                 \
+    vTaskSetThreadLocalStoragePointer(NULL, RP2040config_NMR_TLS_INDEX,                                     \
+        (void *) (uintptr_t) info->replica);                                                                \
+    while(true){                                                                                            \
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    /* Wait for the master to dispatch. */                  \
+        if(!nmr_running_##test_name){                                                                       \
+            break;                                                                                          \
+        }                                                                                                   \
+        save_time_now();                                                                                    \
+        info->return_value=function_name(__VA_ARGS__);                                                      \
+        info->return_time=calc_time_diff();                                                                 \
+        completion_barrier_arrive(&replicas_done_##test_name);                                              \
+    }                                                                                                       \
+    info->stack_free = uxTaskGetStackHighWaterMark(NULL);                                                   \
+    completion_barrier_arrive(&replicas_done_##test_name);                                                  \
+    vTaskDelete(NULL);                                                                                      \
+}                                                                                                           \
+                                                                                                            \
+static void vMasterFunction_##test_name() {                                                                 \
+    struct run_stats vote_stats;                                                                            \
+    uint64_t vote_time = 0;                                                                                 \
+    uint32_t no_majority = 0;                                                                               \
+    return_type voted = (return_type){0};                                                                   \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    run_stats_init(&vote_stats);                                                                            \
+    completion_barrier_init(&replicas_done_##test_name, (n_replicas), xTaskGetCurrentTaskHandle());         \
+    /* Replica r runs on core r % RP2040config_testRUN_ON_CORES. */                                         \
+    for(uint32_t r=0; r<(n_replicas); ++r){                                                                 \
+        return_info_##test_name[r].replica = r;                                                             \
+        nmr_disagreements_##test_name[r] = 0;                                                               \
+        bool created = create_pinned_task(vReplicaFunction_##test_name,                                     \
+            STRING(vReplicaFunction_##test_name),                                                           \
+            &return_info_##test_name[r],                                                                    \
+            r % RP2040config_testRUN_ON_CORES,                                                              \
+            STACK_SLAVE_SIZE(test_name),                                                                    \
+            &return_info_##test_name[r].handle,                                                             \
+            TASK_STORAGE(replica_storage_##test_name, r));                                                  \
+        configASSERT(created);    /* Otherwise the master would wait for it forever. */                     \
+        (void) created;                                                                                     \
+    }                                                                                                       \
+    for(int run=0; run<RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS; ++run){                   \
+        bool agreed;                                                                                        \
+        {                                                                                                   \
+            save_time_now();                                                                                \
+            for(uint32_t r=0; r<(n_replicas); ++r){                                                         \
+                xTaskNotifyGive(return_info_##test_name[r].handle);                                         \
+            }                                                                                               \
+            completion_barrier_wait(&replicas_done_##test_name);                                            \
+            agreed = NMR_VOTER(voter, test_name)(&voted);                                                   \
+            vote_time=calc_time_diff();                                                                     \
+        }                                                                                                   \
+        if(!agreed){                                                                                        \
+            no_majority++;                                                                                  \
+            printf(STRING(test_name)"> check_result: NO_MAJORITY\n");                                       \
+        }                                                                                                   \
+        for(uint32_t r=0; r<(n_replicas); ++r){                                                             \
+            ADD_CHECK_ERROR(test_name, return_info_##test_name[r].return_value, voted)                      \
+            if(!GENERIC_CHECK(return_info_##test_name[r].return_value, voted)){                             \
+                nmr_disagreements_##test_name[r]++;                                                         \
+            }                                                                                               \
+        }                                                                                                   \
+        if(run >= RP2040config_testWARMUP_RUNS){                                                            \
+            run_stats_add(&vote_stats, vote_time);                                                          \
+            EMIT_RESULT(test_name, run - RP2040config_testWARMUP_RUNS, 0, return_info_##test_name[0])       \
+        }                                                                                                   \
     }                                                                                                       \
+    nmr_running_##test_name = false;                                                                        \
+    for(uint32_t r=0; r<(n_replicas); ++r){                                                                 \
+        xTaskNotifyGive(return_info_##test_name[r].handle);                                                 \
+    }                                                                                                       \
+    completion_barrier_wait(&replicas_done_##test_name);                                                    \
+    printf(STRING(test_name)" has ended!\n");                                                               \
+    printf(STRING(test_name)"> replicas:\t %lu \n", (unsigned long) (n_replicas));                          \
+    printf(STRING(test_name)"> voter:\t " NMR_VOTER_NAME(voter) "\n");                                      \
+    printf(STRING(test_name)"> voted:\t" conversion_char"\n", voted);                                       \
+    printf(STRING(test_name)"> no_majority:\t %lu \n", (unsigned long) no_majority);                        \
+    for(uint32_t r=0; r<(n_replicas); ++r){                                                                 \
+        printf(STRING(test_name)"> disagreements_replica_%lu:\t %lu \n",                                    \
+            (unsigned long) r, (unsigned long) nmr_disagreements_##test_name[r]);                           \
+    }                                                                                                       \
+    PRINT_CHECK_ERRORS(test_name)                                                                           \
+    run_stats_print(STRING(test_name)"_vote", 0, &vote_stats, RP2040_TIME_UNIT);                            \
+    printf(STRING(test_name)"> dispatch_time_avg:\t %llu " RP2040_TIME_UNIT "\n",                           \
+        (unsigned long long) vote_stats.mean);                                                              \
+    uint64_t vote_ns = timing_to_ns((uint64_t) vote_stats.mean);                                            \
+    printf(STRING(test_name)"> throughput:\t %lu votes/s \n",                                               \
+        (unsigned long) (vote_ns > 0 ? 1000000000ull / vote_ns : 0));                                       \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, n_replicas, return_info_##test_name[i].stack_free)                         \
+    test_finished(&test_state_##test_name);                                                                 \
     vTaskDelete(NULL);                                                                                      \
 }                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/*
+    Name and definition of the voter function of a test, voter can also be a macro.
+*/
+#define NMR_VOTER(voter, test_name) NMR_VOTER_EXPANDED(voter, test_name)
+#define NMR_VOTER_EXPANDED(voter, test_name) nmr_##voter##_##test_name
+#define NMR_VOTER_NAME(voter) STRING(voter)
+#define NMR_DEFINE_VOTER(voter, test_name, return_type, n_replicas) NMR_DEFINE_VOTER_EXPANDED(voter, test_name, return_type, n_replicas)
+#define NMR_DEFINE_VOTER_EXPANDED(voter, test_name, return_type, n_replicas) NMR_DEFINE_##voter(test_name, return_type, n_replicas)
+
+/*
+    Index of the replica running the calling function (see create_nmr_function_validator).
+*/
+#define nmr_replica_id()                                                                             \
+    ((uint32_t) (uintptr_t) pvTaskGetThreadLocalStoragePointer(NULL, RP2040config_NMR_TLS_INDEX))    \
 
 /**
     Macro which creates the testing pipeline for void functions.
@@ -225,10 +995,15 @@ static void vMasterFunction_##test_name() {
     With the assumptions that it will modify the shared variable stored in return_name.
 
     At the end the value in return_name will be compared with the value contained in expected_value, using the check_function.
+
+    As for "create_multicore_function_validator" the test is repeated (see RP2040config_testREPEAT_RUNS):
+    return_name is restored to its initial value before every run and checked after it.
  */
 
 #define create_multicore_void_function_validator(test_name, return_type, conversion_char, check_function, expected_value, return_name, ...)     \
 static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
                                                                                                             \
 struct return_info_##test_name{                                                                             \
     void (*fn_ptr)();                                                                                       \
@@ -236,48 +1011,442 @@ struct return_info_##test_name{
     uint64_t    return_time;                                                                                \
 };                                                                                                          \
 static struct return_info_##test_name return_info_##test_name[RP2040config_testRUN_ON_CORES];               \
+static struct worker_pool worker_pool_##test_name;                                                          \
+DECLARE_TASK_STORAGE(worker_storage_##test_name,                                                            \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static struct run_stats run_stats_##test_name[RP2040config_testRUN_ON_CORES];                               \
+DECLARE_TELEMETRY(test_name)                                                                                \
+DECLARE_CHECK_ERRORS(test_name)                                                                             \
                                                                                                             \
 static void vSlaveFunction_##test_name(void *pvParameters){                                                 \
     save_time_now();                                                                                        \
     ((struct return_info_##test_name *) pvParameters)->fn_ptr();                                            \
     ((struct return_info_##test_name *) pvParameters)->return_value=return_name;                            \
     ((struct return_info_##test_name *) pvParameters)->return_time=calc_time_diff();                        \
-    xTaskNotifyGive(masterTaskHandle_##test_name);                                                          \
+}                                                                                                           \
+                                                                                                            \
+static void vMasterFunction_##test_name() {                                                                 \
+    uint64_t dispatch_time = 0;                                                                             \
+    uint64_t dispatch_time_total = 0;                                                                       \
+    return_type initial_value = return_name;  /* Every run starts from the same shared value. */            \
+    void(*ptrs[RP2040config_testRUN_ON_CORES])() = { __VA_ARGS__ };                                         \
+    for (unsigned int i = 0; i < sizeof ptrs / sizeof ptrs[0]; i++)                                         \
+        return_info_##test_name[i].fn_ptr=ptrs[i];                                                          \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
+        run_stats_init(&run_stats_##test_name[i]);                                                          \
+    }                                                                                                       \
+    worker_pool_storage(&worker_pool_##test_name, STACK_SLAVE_SIZE(test_name),                              \
+        TASK_STORAGE_ALL(worker_storage_##test_name));                                                      \
+    worker_pool_start(&worker_pool_##test_name,                                                             \
+        STRING(vSlaveFunction_##test_name)STRING(n),                                                        \
+        vSlaveFunction_##test_name,                                                                         \
+        return_info_##test_name,                                                                            \
+        sizeof(return_info_##test_name[0]));                                                                \
+    for(int run=0; run<RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS; ++run){                   \
+        return_name = initial_value;                                                                        \
+        {                                                                                                   \
+            save_time_now();                                                                                \
+            worker_pool_dispatch(&worker_pool_##test_name);                                                 \
+            worker_pool_wait(&worker_pool_##test_name);                                                     \
+            dispatch_time=calc_time_diff();                                                                 \
+        }                                                                                                   \
+        dispatch_time_total+=dispatch_time;                                                                 \
+        ADD_CHECK_ERROR(test_name, return_name, expected_value)                                             \
+        if(!check_function(return_name, expected_value)){                                                   \
+            printf(STRING(test_name)"> check_result: NOT_EQUALS\n");                                        \
+        }                                                                                                   \
+        if(run >= RP2040config_testWARMUP_RUNS){                                                            \
+            ADD_RUN_STATS(test_name, run - RP2040config_testWARMUP_RUNS)                                    \
+        }                                                                                                   \
+    }                                                                                                       \
+    worker_pool_stop(&worker_pool_##test_name);                                                             \
+    printf(STRING(test_name)" has ended!\n");                                                               \
+    PRINT_RUN_STATS(test_name, conversion_char)                                                             \
+    PRINT_CHECK_ERRORS(test_name)                                                                           \
+    PRINT_DISPATCH_STATS(test_name, RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS,               \
+        dispatch_time_total, dispatch_time)                                                                 \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        worker_pool_##test_name.workers[i].stack_free)                                                      \
+    test_finished(&test_state_##test_name);                                                                 \
     vTaskDelete(NULL);                                                                                      \
+}                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/**
+    Macro which creates the testing pipeline for void functions updating a sharded accumulator.
+
+    Arguments:
+
+        - test_name             : unique identifier of the test name.
+        - return_type           : type of the values held by the accumulator.
+        - conversion_char       : identifier to convert the result of the function in a string (e.g. int32_t -> "%d").
+        - check_function        : name of the function used for error checking.
+        - expected_value        : constexpr containing the expected merged value at the end of the execution.
+        - shard_name            : name of the accumulator (see create_sharded_accumulator), updated by the functions.
+        - ...                   : name of the functions launched (one per core).
+
+    It works as "create_multicore_void_function_validator", but the functions update their own slot of
+    shard_name (sharded_add) instead of a variable shared by all the cores, so they need no lock.
+
+    Each core returns its slot, while the merged value (the sum of the slots) is compared with expected_value.
+    Before every run the accumulator is restored to the merged value it had when the test started.
+ */
+
+#define create_multicore_sharded_function_validator(test_name, return_type, conversion_char, check_function, expected_value, shard_name, ...)     \
+static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
+                                                                                                            \
+struct return_info_##test_name{                                                                             \
+    void (*fn_ptr)();                                                                                       \
+    return_type return_value;   /* Slot of the core at the end of the run. */                               \
+    uint64_t    return_time;                                                                                \
+};                                                                                                          \
+static struct return_info_##test_name return_info_##test_name[RP2040config_testRUN_ON_CORES];               \
+static struct worker_pool worker_pool_##test_name;                                                          \
+DECLARE_TASK_STORAGE(worker_storage_##test_name,                                                            \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static struct run_stats run_stats_##test_name[RP2040config_testRUN_ON_CORES];                               \
+DECLARE_TELEMETRY(test_name)                                                                                \
+DECLARE_CHECK_ERRORS(test_name)                                                                             \
+                                                                                                            \
+static void vSlaveFunction_##test_name(void *pvParameters){                                                 \
+    save_time_now();                                                                                        \
+    ((struct return_info_##test_name *) pvParameters)->fn_ptr();                                            \
+    ((struct return_info_##test_name *) pvParameters)->return_value=sharded_slot(shard_name);               \
+    ((struct return_info_##test_name *) pvParameters)->return_time=calc_time_diff();                        \
 }                                                                                                           \
                                                                                                             \
 static void vMasterFunction_##test_name() {                                                                 \
+    uint64_t dispatch_time = 0;                                                                             \
+    uint64_t dispatch_time_total = 0;                                                                       \
+    return_type initial_value = sharded_merge(shard_name);  /* Every run starts from the same value. */     \
+    return_type merged_value = initial_value;                                                               \
     void(*ptrs[RP2040config_testRUN_ON_CORES])() = { __VA_ARGS__ };                                         \
     for (unsigned int i = 0; i < sizeof ptrs / sizeof ptrs[0]; i++)                                         \
         return_info_##test_name[i].fn_ptr=ptrs[i];                                                          \
-    TaskHandle_t vSlaveFunctionHandles[RP2040config_testRUN_ON_CORES];                                      \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
     for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
-        xTaskCreate(vSlaveFunction_##test_name,                                                             \
-            STRING(vSlaveFunction_##test_name)STRING(n),                                                    \
-            RP2040config_tskSLAVE_STACK_SIZE,                                                               \
-            &return_info_##test_name[i],                                                                    \
-            RP2040config_tskSLAVE_PRIORITY,                                                                 \
-            &vSlaveFunctionHandles[i]);                                                                     \
-        vTaskCoreAffinitySet(vSlaveFunctionHandles[i], (1 << i));                                           \
+        run_stats_init(&run_stats_##test_name[i]);                                                          \
     }                                                                                                       \
-    for (int i = 0; i<RP2040config_testRUN_ON_CORES; i++) {                                                 \
-        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                                           \
+    worker_pool_storage(&worker_pool_##test_name, STACK_SLAVE_SIZE(test_name),                              \
+        TASK_STORAGE_ALL(worker_storage_##test_name));                                                      \
+    worker_pool_start(&worker_pool_##test_name,                                                             \
+        STRING(vSlaveFunction_##test_name)STRING(n),                                                        \
+        vSlaveFunction_##test_name,                                                                         \
+        return_info_##test_name,                                                                            \
+        sizeof(return_info_##test_name[0]));                                                                \
+    for(int run=0; run<RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS; ++run){                   \
+        sharded_reset(shard_name, initial_value)                                                            \
+        {                                                                                                   \
+            save_time_now();                                                                                \
+            worker_pool_dispatch(&worker_pool_##test_name);                                                 \
+            worker_pool_wait(&worker_pool_##test_name);                                                     \
+            dispatch_time=calc_time_diff();                                                                 \
+        }                                                                                                   \
+        dispatch_time_total+=dispatch_time;                                                                 \
+        merged_value = sharded_merge(shard_name);                                                           \
+        ADD_CHECK_ERROR(test_name, merged_value, expected_value)                                            \
+        if(!check_function(merged_value, expected_value)){                                                  \
+            printf(STRING(test_name)"> check_result: NOT_EQUALS\n");                                        \
+        }                                                                                                   \
+        if(run >= RP2040config_testWARMUP_RUNS){                                                            \
+            ADD_RUN_STATS(test_name, run - RP2040config_testWARMUP_RUNS)                                    \
+        }                                                                                                   \
     }                                                                                                       \
-    bool check_result=check_function(return_name, expected_value);                                          \
-    if(!check_result){                                                                                      \
-        printf(STRING(test_name)"> check_result: NOT_EQUALS\n");                                            \
+    worker_pool_stop(&worker_pool_##test_name);                                                             \
+    printf(STRING(test_name)" has ended!\n");                                                               \
+    printf(STRING(test_name)"> return_merged:\t" conversion_char"\n", merged_value);                        \
+    PRINT_RUN_STATS(test_name, conversion_char)                                                             \
+    PRINT_CHECK_ERRORS(test_name)                                                                           \
+    PRINT_DISPATCH_STATS(test_name, RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS,              \
+        dispatch_time_total, dispatch_time)                                                                 \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        worker_pool_##test_name.workers[i].stack_free)                                                      \
+    test_finished(&test_state_##test_name);                                                                 \
+    vTaskDelete(NULL);                                                                                      \
+}                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/**
+    Macro which creates the testing pipeline for a computation run in lockstep by all the cores
+    (dual modular redundancy).
+
+    Arguments:
+
+        - test_name             : unique identifier of the test name.
+        - state_type            : type of the state of the computation (copied by value).
+        - init_function         : void init_function(state_type *state), sets the initial state.
+        - segment_function      : void segment_function(state_type *state, uint32_t segment), advances
+                                  the state by one segment.
+        - n_segments            : number of segments of the computation.
+
+    Every core owns a copy of the state and runs the segments one at a time, together with the other
+    cores. During a segment the function can record checkpoints with dmr_checkpoint(test_name, value),
+    and the hash of the state is recorded at its end.
+
+    After each segment the master compares the checkpoints of the cores: if they agree, the state is
+    committed, otherwise the first divergent checkpoint is reported and all the cores restart the
+    segment from the last committed state, up to RP2040config_DMR_MAX_RETRIES times.
+    So a transient fault costs one segment instead of the whole computation.
+
+    The committed state is available as dmr_result(test_name).
+ */
+
+#define create_multicore_dmr_validator(test_name, state_type, init_function, segment_function, n_segments)     \
+static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
+                                                                                                            \
+struct dmr_info_##test_name{                                                                                \
+    state_type state;                                                                                       \
+    uint32_t segment;                                                                                       \
+    uint64_t return_time;                                                                                   \
+};                                                                                                          \
+static struct dmr_info_##test_name dmr_info_##test_name[RP2040config_testRUN_ON_CORES];                     \
+static struct dmr_trace dmr_traces_##test_name[RP2040config_testRUN_ON_CORES];                              \
+static state_type dmr_state_##test_name;    /* Last state agreed by all the cores. */                       \
+static struct worker_pool worker_pool_##test_name;                                                          \
+DECLARE_TASK_STORAGE(worker_storage_##test_name,                                                            \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static struct run_stats run_stats_##test_name[RP2040config_testRUN_ON_CORES];                               \
+DECLARE_TELEMETRY(test_name)                                                                                \
+                                                                                                            \
+static void vSlaveFunction_##test_name(void *pvParameters){                                                 \
+    struct dmr_info_##test_name *info = (struct dmr_info_##test_name *) pvParameters;                       \
+    struct dmr_trace *trace = &dmr_traces_##test_name[get_core_num()];                                      \
+    dmr_trace_reset(trace);                                                                                 \
+    save_time_now();                                                                                        \
+    segment_function(&info->state, info->segment);                                                          \
+    info->return_time=calc_time_diff();                                                                     \
+    dmr_trace_add(trace, dmr_hash(&info->state, sizeof(info->state)));  /* State at the end. */             \
+}                                                                                                           \
+                                                                                                            \
+static void vMasterFunction_##test_name() {                                                                 \
+    uint32_t divergences = 0, retries = 0, segments_run = 0;                                                \
+    uint32_t first_segment = DMR_AGREE, first_checkpoint = DMR_AGREE;                                       \
+    bool failed = false;                                                                                    \
+    init_function(&dmr_state_##test_name);                                                                  \
+    for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
+        dmr_info_##test_name[i].state = dmr_state_##test_name;                                              \
+        run_stats_init(&run_stats_##test_name[i]);                                                          \
     }                                                                                                       \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    worker_pool_storage(&worker_pool_##test_name, STACK_SLAVE_SIZE(test_name),                              \
+        TASK_STORAGE_ALL(worker_storage_##test_name));                                                      \
+    worker_pool_start(&worker_pool_##test_name,                                                             \
+        STRING(vSlaveFunction_##test_name)STRING(n),                                                        \
+        vSlaveFunction_##test_name,                                                                         \
+        dmr_info_##test_name,                                                                               \
+        sizeof(dmr_info_##test_name[0]));                                                                   \
+    for(uint32_t segment=0, attempt=0; segment<(n_segments) && !failed; ){                                  \
+        for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                  \
+            dmr_info_##test_name[i].segment = segment;                                                      \
+        }                                                                                                   \
+        worker_pool_dispatch(&worker_pool_##test_name);                                                     \
+        worker_pool_wait(&worker_pool_##test_name);                                                         \
+        segments_run++;                                                                                     \
+        uint32_t checkpoint = dmr_trace_compare(dmr_traces_##test_name);                                    \
+        if(checkpoint == DMR_AGREE){                                                                        \
+            for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+                run_stats_add(&run_stats_##test_name[i], dmr_info_##test_name[i].return_time);              \
+            }                                                                                               \
+            dmr_state_##test_name = dmr_info_##test_name[0].state;    /* Commit. */                         \
+            segment++;                                                                                      \
+            attempt = 0;                                                                                    \
+            continue;                                                                                       \
+        }                                                                                                   \
+        divergences++;                                                                                      \
+        if(first_segment == DMR_AGREE){                                                                     \
+            first_segment = segment;                                                                        \
+            first_checkpoint = checkpoint;                                                                  \
+        }                                                                                                   \
+        printf(STRING(test_name)"> divergence:\t segment %lu checkpoint %lu attempt %lu\n",                 \
+            (unsigned long) segment, (unsigned long) checkpoint, (unsigned long) attempt);                  \
+        if(attempt == RP2040config_DMR_MAX_RETRIES){                                                        \
+            failed = true;                                                                                  \
+            break;                                                                                          \
+        }                                                                                                   \
+        attempt++;                                                                                          \
+        retries++;                                                                                          \
+        for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                  \
+            dmr_info_##test_name[i].state = dmr_state_##test_name;    /* Roll back. */                      \
+        }                                                                                                   \
+    }                                                                                                       \
+    worker_pool_stop(&worker_pool_##test_name);                                                             \
     printf(STRING(test_name)" has ended!\n");                                                               \
     for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
-        printf(                                                                                             \
-            STRING(test_name)"> return_core_%d:\t" conversion_char"\n",                                     \
-            i,  return_info_##test_name[i].return_value);                                                   \
-        printf(                                                                                             \
-            STRING(test_name)"> return_time_%d:\t %llu \n",                                                 \
-            i,  return_info_##test_name[i].return_time);                                                    \
+        run_stats_print(STRING(test_name), i, &run_stats_##test_name[i], RP2040_TIME_UNIT);                 \
+    }                                                                                                       \
+    printf(STRING(test_name)"> segments_run:\t %lu \n", (unsigned long) segments_run);                      \
+    printf(STRING(test_name)"> divergences:\t %lu \n", (unsigned long) divergences);                        \
+    printf(STRING(test_name)"> retries:\t %lu \n", (unsigned long) retries);                                \
+    if(first_segment != DMR_AGREE){                                                                         \
+        printf(STRING(test_name)"> first_divergence:\t segment %lu checkpoint %lu \n",                      \
+            (unsigned long) first_segment, (unsigned long) first_checkpoint);                               \
+    }                                                                                                       \
+    printf(STRING(test_name)"> state_hash:\t %08lx \n",                                                     \
+        (unsigned long) dmr_hash(&dmr_state_##test_name, sizeof(dmr_state_##test_name)));                   \
+    printf(STRING(test_name)"> %s\n", failed ? "FAILED" : "AGREED");                                        \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        worker_pool_##test_name.workers[i].stack_free)                                                      \
+    test_finished(&test_state_##test_name);                                                                 \
+    vTaskDelete(NULL);                                                                                      \
+}                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/*
+    Records value (any lvalue) in the trace of the calling core, used in the segment_function
+    of create_multicore_dmr_validator.
+*/
+#define dmr_checkpoint(test_name, value)                                                             \
+dmr_trace_add(&dmr_traces_##test_name[get_core_num()], dmr_hash(&(value), sizeof(value)))            \
+
+#define dmr_result(test_name) (dmr_state_##test_name)
+
+/**
+    Macro which creates the testing pipeline for functions producing an output too large to be returned by value.
+
+    Arguments:
+
+        - test_name         : unique identifier of the test name.
+        - buffer_size       : bytes of the buffer of each core, at most
+                              RP2040config_DIGEST_CHUNK_SIZE * RP2040config_DIGEST_MAX_CHUNKS.
+        - function_name     : void function_name(struct digest_stream *out, ...), writing its output
+                              with digest_write(out, data, size) or digest_put(out, value).
+        - ...               : arguments passed as inputs to the function, after out.
+
+    Every core writes into its own buffer, while the digest of the output is computed chunk by chunk
+    (see LibraryFreeRTOS_RP2040Digest.h): the master compares only the digests of the cores,
+    as "create_multicore_function_validator" compares the values returned.
+
+    When the digests differ, the first byte which differs is located comparing only the first chunk
+    whose digests differ, and reported with the mismatch; the run is retried following the retry policy
+    of the test (see configure_retry). The last byte located is available as digest_mismatch(test_name).
+
+    The digest of each core is printed as its return value, together with the size of the output
+    and the mean time taken by the master to compare the outputs.
+ */
+
+#define create_multicore_buffer_validator(test_name, buffer_size, function_name, ...)                       \
+static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
+_Static_assert((buffer_size) <= (size_t) RP2040config_DIGEST_CHUNK_SIZE * RP2040config_DIGEST_MAX_CHUNKS,   \
+    STRING(test_name)": buffer_size exceeds RP2040config_DIGEST_MAX_CHUNKS chunks");                        \
+                                                                                                            \
+struct return_info_##test_name{                                                                             \
+    struct digest_stream stream;                                                                            \
+    uint32_t    return_value;   /* Digest of the output. */                                                 \
+    uint64_t    return_time;                                                                                \
+};                                                                                                          \
+static struct return_info_##test_name return_info_##test_name[RP2040config_testRUN_ON_CORES];               \
+static uint8_t digest_buffers_##test_name[RP2040config_testRUN_ON_CORES][buffer_size]                       \
+    __attribute__((aligned(4)));                                                                            \
+static size_t digest_mismatch_##test_name = DIGEST_AGREE;                                                   \
+static struct worker_pool worker_pool_##test_name;                                                          \
+DECLARE_TASK_STORAGE(worker_storage_##test_name,                                                            \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static struct run_stats run_stats_##test_name[RP2040config_testRUN_ON_CORES];                               \
+static struct retry_policy retry_policy_##test_name = RETRY_POLICY_DEFAULT;                                 \
+static struct retry_stats retry_stats_##test_name;                                                          \
+DECLARE_TELEMETRY(test_name)                                                                                \
+                                                                                                            \
+static void vSlaveFunction_##test_name(void *pvParameters){                                                 \
+    struct return_info_##test_name *info = (struct return_info_##test_name *) pvParameters;                 \
+    digest_reset(&info->stream);                                                                            \
+    save_time_now();                                                                                        \
+    function_name(&info->stream, ##__VA_ARGS__);                                                            \
+    info->return_value=digest_finish(&info->stream);                                                        \
+    info->return_time=calc_time_diff();                                                                     \
+}                                                                                                           \
+                                                                                                            \
+static void vMasterFunction_##test_name() {                                                                 \
+    bool check_result = false;                                                                              \
+    uint32_t dispatch_count = 0;                                                                            \
+    uint64_t dispatch_time = 0;                                                                             \
+    uint64_t dispatch_time_total = 0;                                                                       \
+    uint64_t compare_time_total = 0;                                                                        \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
+        digest_init(&return_info_##test_name[i].stream, digest_buffers_##test_name[i], (buffer_size));      \
+        run_stats_init(&run_stats_##test_name[i]);                                                          \
     }                                                                                                       \
+    retry_stats_init(&retry_stats_##test_name);                                                             \
+    worker_pool_storage(&worker_pool_##test_name, STACK_SLAVE_SIZE(test_name),                              \
+        TASK_STORAGE_ALL(worker_storage_##test_name));                                                      \
+    worker_pool_start(&worker_pool_##test_name,                                                             \
+        STRING(vSlaveFunction_##test_name)STRING(n),                                                        \
+        vSlaveFunction_##test_name,                                                                         \
+        return_info_##test_name,                                                                            \
+        sizeof(return_info_##test_name[0]));                                                                \
+    for(int run=0; run<RP2040config_testWARMUP_RUNS+RP2040config_testREPEAT_RUNS; ++run){                   \
+        uint32_t attempts = 0;                                                                              \
+        check_result = false;                                                                               \
+        while(!check_result){                                                                               \
+            {                                                                                               \
+                save_time_now();                                                                            \
+                worker_pool_dispatch(&worker_pool_##test_name);                                             \
+                worker_pool_wait(&worker_pool_##test_name);                                                 \
+                dispatch_time=calc_time_diff();                                                             \
+            }                                                                                               \
+            dispatch_count++;                                                                               \
+            dispatch_time_total+=dispatch_time;                                                             \
+            attempts++;                                                                                     \
+            {                                                                                               \
+                save_time_now();                                                                            \
+                CHECK_GENERATION(DEFAULT_CHECK, return_info_##test_name)                                    \
+                compare_time_total+=calc_time_diff();                                                       \
+            }                                                                                               \
+            if(!check_result){                                                                              \
+                for(int i=1; i<RP2040config_testRUN_ON_CORES; ++i){                                         \
+                    size_t offset = digest_locate(&return_info_##test_name[0].stream,                       \
+                        &return_info_##test_name[i].stream);                                                \
+                    if(offset != DIGEST_AGREE){                                                             \
+                        digest_mismatch_##test_name = offset;                                               \
+                        printf(STRING(test_name)"> check_result: NOT_EQUALS at byte %lu "                   \
+                            "(chunk %lu) of core %d\n", (unsigned long) offset,                             \
+                            (unsigned long) (offset / RP2040config_DIGEST_CHUNK_SIZE), i);                  \
+                    }                                                                                       \
+                }                                                                                           \
+                RETRY_AFTER_MISMATCH(test_name, run, attempts, dispatch_time)                               \
+            }                                                                                               \
+        }                                                                                                   \
+        retry_stats_##test_name.retries += attempts - 1;                                                    \
+        if(check_result && run >= RP2040config_testWARMUP_RUNS){                                            \
+            ADD_RUN_STATS(test_name, run - RP2040config_testWARMUP_RUNS)                                    \
+        }                                                                                                   \
+    }                                                                                                       \
+    worker_pool_stop(&worker_pool_##test_name);                                                             \
+    printf(STRING(test_name)" has ended!\n");                                                               \
+    PRINT_RUN_STATS(test_name, " %08" PRIx32)                                                               \
+    printf(STRING(test_name)"> output_size:\t %lu bytes\n",                                                 \
+        (unsigned long) return_info_##test_name[0].stream.size);                                            \
+    printf(STRING(test_name)"> compare_time_avg:\t %llu " RP2040_TIME_UNIT "\n",                            \
+        (unsigned long long) (compare_time_total/dispatch_count));                                          \
+    PRINT_DISPATCH_STATS(test_name, dispatch_count, dispatch_time_total, dispatch_time)                     \
+    PRINT_RETRY_STATS(test_name)                                                                            \
+    WAIT_TELEMETRY(test_name)                                                                               \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        worker_pool_##test_name.workers[i].stack_free)                                                      \
+    test_finished(&test_state_##test_name);                                                                 \
     vTaskDelete(NULL);                                                                                      \
 }                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
+
+/*
+    Offset of the first byte which differed between the outputs of the cores in the last
+    mismatch of a test created by create_multicore_buffer_validator, DIGEST_AGREE if none.
+*/
+#define digest_mismatch(test_name) (digest_mismatch_##test_name)
 
 /**
     Macro which creates the testing pipeline for user-defined functions.
@@ -308,104 +1477,378 @@ static void vMasterFunction_##test_name() {
 
 #define create_multicore_task_validator(test_name, MasterSetup, MasterLoop, SlaveSetup, SlaveLoop, return_type, conversion_char)          \
 static TaskHandle_t masterTaskHandle_##test_name = NULL;                                                    \
+DECLARE_TASK_STORAGE(master_storage_##test_name, 1, STACK_MASTER_SIZE(test_name))                           \
+static struct test_state test_state_##test_name;                                                            \
 /* Define the appropriate data structure for the communication between master and slave. */                 \
 /* It contains also the time taken to execute the iteration, calculated automatically. */                   \
 struct return_info_##test_name{                                                                             \
     void *input;                                                                                            \
+    struct broadcast_channel *channel; /* Not NULL if the input has been published in place. */             \
+    uint32_t batch_count;   /* Number of inputs of the batch, 0 if a single input has been prepared. */     \
+    size_t batch_stride;    /* Distance in bytes between two inputs of the batch. */                        \
+    uint32_t iteration;     /* Pipelined mode: iteration of the input, written by the master. */            \
+    uint32_t completed;     /* Pipelined mode: iteration of the result, written by the slave. */            \
     return_type return_value;                                                                               \
     uint64_t return_time;                                                                                   \
+    return_type batch_values[RP2040config_BATCH_SIZE];                                                      \
+    uint64_t batch_times[RP2040config_BATCH_SIZE];                                                          \
 };                                                                                                          \
 /* This variable is used to control the execution of the MasterTask. */                                     \
 static bool should_continue##test_name=true;                                                                \
 /* This variable is used to control the execution of the SlaveTask. */                                      \
 static bool slave_operative##test_name=true;                                                                \
-static struct return_info_##test_name return_info_slaves[RP2040config_testRUN_ON_CORES];                    \
-static TaskHandle_t vSlaveFunctionHandles[RP2040config_testRUN_ON_CORES];                                   \
+static struct return_info_##test_name return_info_slaves_##test_name[RP2040config_testRUN_ON_CORES];        \
+static TaskHandle_t vSlaveFunctionHandles_##test_name[RP2040config_testRUN_ON_CORES];                       \
+DECLARE_TASK_STORAGE(slave_storage_##test_name,                                                             \
+    RP2040config_testRUN_ON_CORES, STACK_SLAVE_SIZE(test_name))                                             \
+static UBaseType_t stack_free_##test_name[RP2040config_testRUN_ON_CORES];                                   \
+/* Slots used in pipelined mode: iteration k uses the row k % RP2040config_PIPELINE_DEPTH. */               \
+static struct return_info_##test_name return_info_pipeline_##test_name[RP2040config_PIPELINE_DEPTH][RP2040config_testRUN_ON_CORES]; \
+static struct pipeline_state pipeline_state_##test_name;                                                    \
+/* Completion of the inputs which are not pipelined, waited by the master. */                               \
+static struct completion_barrier completion_##test_name;                                                    \
+DECLARE_TELEMETRY(test_name)                                                                                \
+DECLARE_FAULTS(test_name)                                                                                   \
+DECLARE_CHECK_ERRORS(test_name)                                                                             \
 /* Create the function executed by the slave. */                                                            \
 /* It is includes  setup and loop phases. */                                                                \
 static void vSlaveFunction_##test_name(){                                                                   \
     void *input;                                                                                            \
+    struct broadcast_channel *channel;                                                                      \
+    uint32_t pipeline_done = 0;     /* Number of pipelined inputs processed by this slave. */               \
     int coreNum = get_core_num(); /* Get the core number where the task is running. */                      \
     SlaveSetup();                                                                                           \
     while(true){                                                                                            \
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  /* Wait that the master pushes something*/                \
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);  /* Wait that the master pushes something (one per input)*/\
         if(!slave_operative##test_name){                                                                    \
             break;    /* If the input is the exit pipeline, then we stop the task. */                       \
         }                                                                                                   \
-        input = return_info_slaves[coreNum].input; /* Get the input pointer. */                             \
-        save_time_now();   /* Save the time. */                                                             \
-        return_info_slaves[coreNum].return_value=SlaveLoop(input);  /* Perform the loop specified by the user. */\
-        return_info_slaves[coreNum].return_time=calc_time_diff();   /* Calculate the time and store it. */  \
-        xTaskNotifyGive(masterTaskHandle_##test_name);                                                      \
+        if(pipeline_done < pipeline_state_##test_name.submitted){                                           \
+            run_pipelined_on_slave(return_info_pipeline_##test_name[pipeline_done % RP2040config_PIPELINE_DEPTH][coreNum], SlaveLoop); \
+            pipeline_done++;                                                                                \
+            xTaskNotifyGive(masterTaskHandle_##test_name);                                                  \
+            continue;                                                                                       \
+        }                                                                                                   \
+        channel = return_info_slaves_##test_name[coreNum].channel;                                          \
+        if(channel != NULL){                                                                                \
+            input = (void *) broadcast_read(channel, coreNum, NULL); /* Read the shared input in place. */  \
+        } else {                                                                                            \
+            input = return_info_slaves_##test_name[coreNum].input; /* Get the input pointer. */             \
+        }                                                                                                   \
+        if(return_info_slaves_##test_name[coreNum].batch_count == 0){                                       \
+            save_time_now();   /* Save the time. */                                                         \
+            FAULT_DELAY(test_name, coreNum)                                                                 \
+            return_info_slaves_##test_name[coreNum].return_value=SlaveLoop(input);  /* Perform the loop specified by the user. */ \
+            return_info_slaves_##test_name[coreNum].return_time=calc_time_diff();   /* Calculate the time and store it. */ \
+            FAULT_FLIP(test_name, FAULT_FLIP_RESULT, coreNum,                                               \
+                return_info_slaves_##test_name[coreNum].return_value)                                       \
+        } else {                                                                                            \
+            run_batch_on_slave(return_info_slaves_##test_name[coreNum], SlaveLoop, input);                  \
+        }                                                                                                   \
+        if(channel != NULL){                                                                                \
+            broadcast_release(channel, coreNum); /* The master can reuse the slot. */                       \
+        }                                                                                                   \
+        completion_barrier_arrive(&completion_##test_name);                                                 \
     }                                                                                                       \
     printf("Slave %s received exit pipeline, exiting...\n", STRING(vSlaveFunction_##test_name));            \
-    xTaskNotifyGive(masterTaskHandle_##test_name);                                                          \
+    stack_free_##test_name[coreNum] = uxTaskGetStackHighWaterMark(NULL);                                    \
+    completion_barrier_arrive(&completion_##test_name);                                                     \
     /* Cleanup resources. */                                                                                \
     vTaskDelete(NULL);                                                                                      \
 }                                                                                                           \
                                                                                                             \
                                                                                                             \
 static void vMasterFunction_##test_name() {                                                                 \
+    timing_calibrate();                                                                                     \
+    REGISTER_TELEMETRY(test_name)                                                                           \
+    completion_barrier_init(&completion_##test_name, RP2040config_testRUN_ON_CORES,                         \
+        xTaskGetCurrentTaskHandle());                                                                       \
     MasterSetup();                                                                                          \
     vTaskSuspendAll();    /* Suspend scheduler so to allow creating new tasks */                            \
     for(int i=0;i<RP2040config_testRUN_ON_CORES; i++){      /* Create the slave tasks and assign them each to a core. */\
-        xTaskCreate(vSlaveFunction_##test_name,                                                             \
+        create_task(vSlaveFunction_##test_name,                                                             \
             STRING(vSlaveFunction_##test_name)STRING(n),                                                    \
-            RP2040config_tskSLAVE_STACK_SIZE,                                                               \
+            STACK_SLAVE_SIZE(test_name),                                                                    \
             NULL,                                                                                           \
             RP2040config_tskSLAVE_PRIORITY,                                                                 \
-            &vSlaveFunctionHandles[i]);                                                                     \
-        vTaskCoreAffinitySet(vSlaveFunctionHandles[i], (1 << i));                                           \
+            &vSlaveFunctionHandles_##test_name[i],                                                          \
+            TASK_STORAGE(slave_storage_##test_name, i));                                                    \
+        vTaskCoreAffinitySet(vSlaveFunctionHandles_##test_name[i], (1 << i));                               \
     }                                                                                                       \
     xTaskResumeAll();    /* Resume the scheduler so to allow the tasks to run. */                           \
+    uint32_t iteration = 0;                                                                                 \
     while(should_continue##test_name){                                                                      \
         MasterLoop();                                                                                       \
-        for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                                \
-            if(return_info_slaves[i].input != NULL){                                                        \
-                free(return_info_slaves[i].input); /* Free the input pointer */                             \
-                return_info_slaves[i].input = NULL; /* Set the input pointer to NULL to avoid double free. */ \
-            }                                                                                               \
-        }                                                                                                   \
         for(int i=0;i<RP2040config_testRUN_ON_CORES && should_continue##test_name; ++i){                    \
-            printf(                                                                                         \
-                STRING(test_name)"> return_core_id__core:\t %d\n",                                          \
-                i);                                                                                         \
-            printf(                                                                                         \
-                STRING(test_name)"> return_value_core_%d:\t" conversion_char"\n",                           \
-                i, return_info_slaves[i].return_value);                                                     \
-            printf(                                                                                         \
-                STRING(test_name)"> return_time__core_%d:\t%llu\n\n",                                       \
-                i, return_info_slaves[i].return_time);                                                      \
+            REPORT_SLAVE_RESULT(test_name, iteration, i, conversion_char)                                   \
         }                                                                                                   \
+        iteration++;                                                                                        \
     }                                                                                                       \
+    PRINT_CHECK_ERRORS(test_name)                                                                           \
+    PRINT_FAULT_STATS(test_name)                                                                            \
+    WAIT_TELEMETRY(test_name)                                                                               \
     /* Notify the slaves to exit the pipeline. */                                                           \
     printf("Master %s received exit command, exiting...\n", STRING(vMasterFunction_##test_name));           \
     slave_operative##test_name=false;                                                                       \
     for(int i=0;i<RP2040config_testRUN_ON_CORES; ++i){                                                      \
-        xTaskNotifyGive(vSlaveFunctionHandles[i]);                                                          \
-    }                                                                                                       \
-    for(int i=0;i<(RP2040config_testRUN_ON_CORES); ++i){  /* Wait for the slaves to finish. */              \
-        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                                           \
+        xTaskNotifyGive(vSlaveFunctionHandles_##test_name[i]);                                              \
     }                                                                                                       \
+    completion_barrier_wait(&completion_##test_name);  /* Wait for the slaves to finish. */                 \
     /* Cleanup resources. */                                                                                \
+    PRINT_STACK_STATS(test_name, RP2040config_testRUN_ON_CORES,                                             \
+        stack_free_##test_name[i])                                                                          \
+    test_finished(&test_state_##test_name);                                                                 \
     vTaskDelete(NULL);                                                                                      \
 }                                                                                                           \
+REGISTER_TEST(test_name)                                                                                    \
 
+/**
+    Macro used by MasterLoop to hand the same input to all the slaves and wake them up.
+
+    test_name:      the name of the test.
+    input_usr:      variable holding the input (copied by value).
+
+    Every core receives its own copy of the input, stored in a static ring of
+    RP2040config_INPUT_RING_SLOTS slots declared at the call site and typed from the input itself,
+    so that a dispatch never touches the heap.
+    It must be called at most once in the body of MasterLoop.
+*/
 #define prepare_input_for_slaves(test_name, input_usr)                                                      \
+static __typeof__(input_usr) input_ring_##test_name[RP2040config_INPUT_RING_SLOTS][RP2040config_testRUN_ON_CORES]; \
+static uint32_t input_ring_head_##test_name = 0;                                                            \
+FAULT_PLAN(test_name, ~0u)                                                                                  \
+for(int i=0;i<RP2040config_testRUN_ON_CORES;++i){                                                           \
+    /* Duplicate variable to avoid concurrencies*/                                                          \
+    memcpy(&input_ring_##test_name[input_ring_head_##test_name][i], &input_usr, sizeof(input_usr));         \
+    FAULT_FLIP(test_name, FAULT_CORRUPT_INPUT, i, input_ring_##test_name[input_ring_head_##test_name][i])   \
+    return_info_slaves_##test_name[i].input = &input_ring_##test_name[input_ring_head_##test_name][i];      \
+    return_info_slaves_##test_name[i].channel = NULL;                                                       \
+    return_info_slaves_##test_name[i].batch_count = 0;                                                      \
+}                                                                                                           \
+input_ring_head_##test_name = (input_ring_head_##test_name + 1) % RP2040config_INPUT_RING_SLOTS;            \
+for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){                                                         \
+    xTaskNotifyGive(vSlaveFunctionHandles_##test_name[j]);                                                  \
+}                                                                                                           \
+
+/**
+    Macro used by MasterLoop to hand the same input to all the slaves without copying it per core.
+
+    test_name:      the name of the test.
+    input_usr:      variable holding the input.
+
+    The input is published once in a broadcast channel (see LibraryFreeRTOS_RP2040Broadcast.h)
+    declared static at the call site, and every slave reads it in place.
+    The slot is released when all the slaves have acknowledged it, after SlaveLoop returns,
+    so SlaveLoop must not keep the input pointer across iterations.
+    It must be called at most once in the body of MasterLoop, and not together with
+    prepare_input_for_slaves for the same test.
+*/
+#define publish_input_for_slaves(test_name, input_usr)                                                      \
+static __typeof__(input_usr) input_slots_##test_name[RP2040config_BROADCAST_SLOTS];                         \
+static struct broadcast_channel input_channel_##test_name;                                                  \
+static bool input_channel_ready_##test_name = false;                                                        \
+FAULT_PLAN(test_name, ~FAULT_CORRUPT_INPUT)  /* The input is shared by the cores. */                        \
+if(!input_channel_ready_##test_name){                                                                       \
+    broadcast_init(&input_channel_##test_name, input_slots_##test_name, sizeof(input_usr));                 \
+    input_channel_ready_##test_name = true;                                                                 \
+}                                                                                                           \
+{                                                                                                           \
+    void *slot_ptr;                                                                                         \
+    while((slot_ptr = broadcast_acquire(&input_channel_##test_name)) == NULL){                              \
+        taskYIELD();    /* Some slave is still reading the oldest input. */                                 \
+    }                                                                                                       \
+    memcpy(slot_ptr, &input_usr, sizeof(input_usr));                                                        \
+    broadcast_publish(&input_channel_##test_name, sizeof(input_usr));                                       \
+}                                                                                                           \
+for(int i=0;i<RP2040config_testRUN_ON_CORES;++i){                                                           \
+    return_info_slaves_##test_name[i].channel = &input_channel_##test_name;                                 \
+    return_info_slaves_##test_name[i].batch_count = 0;                                                      \
+}                                                                                                           \
+for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){                                                         \
+    xTaskNotifyGive(vSlaveFunctionHandles_##test_name[j]);                                                  \
+}                                                                                                           \
+
+/**
+    Macro used by MasterLoop to hand a batch of inputs to all the slaves with a single wake up.
+
+    test_name:      the name of the test.
+    inputs_usr:     array holding the inputs.
+    count:          number of inputs in the batch (at most RP2040config_BATCH_SIZE).
+
+    The batch is copied once in a static buffer declared at the call site, which all the
+    slaves read in place: each of them runs SlaveLoop over every input of the batch.
+    The outputs must be collected with receive_batch_from_slaves.
+    It must be called at most once in the body of MasterLoop.
+*/
+#define prepare_batch_for_slaves(test_name, inputs_usr, count)                                              \
+static __typeof__((inputs_usr)[0]) input_batch_##test_name[RP2040config_BATCH_SIZE];                        \
+configASSERT((count) > 0 && (count) <= RP2040config_BATCH_SIZE);                                            \
+memcpy(input_batch_##test_name, (inputs_usr), (count)*sizeof(input_batch_##test_name[0]));                  \
 for(int i=0;i<RP2040config_testRUN_ON_CORES;++i){                                                           \
-    void * input_ptr = malloc(sizeof(input_usr));                                                           \
-    if(input_ptr == NULL){                                                                                  \
-        printf("Error allocating memory for input pointer in %s\n", STRING(test_name));                     \
-        exit_test_pipeline(test_name);                                                                      \
-        return;                                                                                             \
+    return_info_slaves_##test_name[i].input = input_batch_##test_name;                                      \
+    return_info_slaves_##test_name[i].channel = NULL;                                                       \
+    return_info_slaves_##test_name[i].batch_count = (count);                                                \
+    return_info_slaves_##test_name[i].batch_stride = sizeof(input_batch_##test_name[0]);                    \
+}                                                                                                           \
+for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){                                                         \
+    xTaskNotifyGive(vSlaveFunctionHandles_##test_name[j]);                                                  \
+}                                                                                                           \
+
+/*
+    Macro used by the slave to run SlaveLoop over the batch prepared by the master.
+    The time of each input is stored in batch_times, the time of the whole batch in return_time.
+*/
+#define run_batch_on_slave(info, SlaveLoop, input)                                                          \
+{                                                                                                           \
+    uint64_t batch_time = 0;                                                                                \
+    for(uint32_t k=0; k<(info).batch_count; ++k){                                                           \
+        save_time_now();                                                                                    \
+        (info).batch_values[k]=SlaveLoop((char *) (input) + k*(info).batch_stride);                         \
+        (info).batch_times[k]=calc_time_diff();                                                             \
+        batch_time += (info).batch_times[k];                                                                \
+    }                                                                                                       \
+    (info).return_value = (info).batch_values[(info).batch_count-1];                                        \
+    (info).return_time = batch_time;                                                                        \
+}                                                                                                           \
+
+/** Function used to receive the outputs of a batch from the slaves:
+
+    test_name:      the name of the test.
+    check_function: used to check the results of the slaves, item by item.
+    outputs:        array receiving the output of each input of the batch.
+    outcomes:       array of bool, true if the check of the corresponding input was successful.
+    failures:       number of inputs of the batch whose check failed.
+*/
+#define receive_batch_from_slaves(test_name, check_function, outputs, outcomes, failures)                   \
+completion_barrier_wait(&completion_##test_name); /* Wait for the tasks to finish. */               \
+failures = 0;                                                                                       \
+for(uint32_t k=0; k<return_info_slaves_##test_name[0].batch_count; ++k){                            \
+    bool item_equal = true;                                                                         \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES-1; i++){                                           \
+        ADD_CHECK_ERROR(test_name, return_info_slaves_##test_name[i].batch_values[k],               \
+            return_info_slaves_##test_name[i+1].batch_values[k])                                    \
+        if(!check_function(return_info_slaves_##test_name[i].batch_values[k],                       \
+                return_info_slaves_##test_name[i+1].batch_values[k])){                              \
+            item_equal = false;                                                                     \
+            break;                                                                                  \
+        }                                                                                           \
+    }                                                                                               \
+    (outcomes)[k] = item_equal;                                                                     \
+    (outputs)[k] = item_equal ? return_info_slaves_##test_name[0].batch_values[k] :                 \
+        (__typeof__((outputs)[k])){0};                                                              \
+    failures += item_equal ? 0 : 1;                                                                 \
+}                                                                                                   \
+
+/**
+    Macro used by MasterLoop to submit an input in pipelined mode, without waiting for the slaves.
+
+    test_name:      the name of the test.
+    input_usr:      variable holding the input (copied by value, one copy per core).
+
+    Up to RP2040config_PIPELINE_DEPTH inputs can be in flight: while the slaves compute iteration k
+    the master can already prepare and submit iteration k+1. Each input goes to its own set of
+    return_info_pipeline_<test_name> slots, tagged with the number of the iteration.
+    Before submitting, the master must collect the oldest iteration if pipeline_full(test_name),
+    and it must collect all of them (pipeline_in_flight(test_name) == 0) before using the
+    other prepare_* macros or exiting the pipeline.
+    It must be called at most once in the body of MasterLoop.
+*/
+#define submit_input_to_slaves(test_name, input_usr)                                                        \
+static __typeof__(input_usr) input_pipeline_##test_name[RP2040config_PIPELINE_DEPTH][RP2040config_testRUN_ON_CORES]; \
+configASSERT(!pipeline_full(test_name));                                                                    \
+{                                                                                                           \
+    uint32_t slot = pipeline_state_##test_name.submitted % RP2040config_PIPELINE_DEPTH;                     \
+    for(int i=0;i<RP2040config_testRUN_ON_CORES;++i){                                                       \
+        memcpy(&input_pipeline_##test_name[slot][i], &input_usr, sizeof(input_usr));                        \
+        return_info_pipeline_##test_name[slot][i].input = &input_pipeline_##test_name[slot][i];             \
+        return_info_pipeline_##test_name[slot][i].iteration = pipeline_state_##test_name.submitted;         \
     }                                                                                                       \
-    memcpy(input_ptr, &input_usr, sizeof(input_usr)); /* Duplicate variable to avoid concurrencies*/        \
-    return_info_slaves[i].input = input_ptr;                                                                \
+    pipeline_state_##test_name.submitted++;                                                                 \
 }                                                                                                           \
 for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){                                                         \
-    xTaskNotifyGive(vSlaveFunctionHandles[j]);                                                              \
+    xTaskNotifyGive(vSlaveFunctionHandles_##test_name[j]);                                                  \
 }                                                                                                           \
 
+/*
+    Macros returning the number of iterations submitted and not collected yet,
+    and whether a new one can be submitted.
+*/
+#define pipeline_in_flight(test_name)                                                               \
+    (pipeline_state_##test_name.submitted - pipeline_state_##test_name.collected)                   \
+
+#define pipeline_full(test_name)                                                                    \
+    (pipeline_in_flight(test_name) >= RP2040config_PIPELINE_DEPTH)                                  \
+
+/*
+    Macro used by the slave to process a pipelined input.
+    The iteration of the result is published last, so that the master never reads a partial result.
+*/
+#define run_pipelined_on_slave(info, SlaveLoop)                                                             \
+{                                                                                                           \
+    save_time_now();                                                                                        \
+    (info).return_value=SlaveLoop((info).input);                                                            \
+    (info).return_time=calc_time_diff();                                                                    \
+    __atomic_store_n(&(info).completed, (info).iteration + 1, __ATOMIC_RELEASE);                            \
+}                                                                                                           \
+
+/** Function used to receive the output of the oldest iteration in flight (pipelined mode):
+
+    test_name:      the name of the test.
+    check_function: used to check the results of the slaves.
+    output:         returned value
+    outcome:        true if the check was successful, false otherwise.
+    iteration:      number of the iteration collected (0 for the first input submitted).
+
+    Iterations are collected strictly in the order they were submitted. The results of
+    the cores are compared only if all of them are tagged with the iteration being collected,
+    otherwise outcome is false. The collected results are also copied in return_info_slaves_<test_name>.
+    The master waits on the iteration published in each slot, not on a count of notifications:
+    a notification only wakes it up to look again. Each slave still notifies the master once per
+    pipelined input, after publishing it, so before returning the master takes the notifications
+    still due for the iterations collected: none is left for the completion barrier, which without
+    RP2040config_USE_COMPLETION_BARRIER counts the notifications of the master.
+*/
+#define collect_output_from_slaves(test_name, check_function, output, outcome, iteration)          \
+configASSERT(pipeline_in_flight(test_name) > 0);                                                    \
+iteration = pipeline_state_##test_name.collected;                                                   \
+{                                                                                                   \
+    struct return_info_##test_name *slot =                                                          \
+        return_info_pipeline_##test_name[pipeline_state_##test_name.collected % RP2040config_PIPELINE_DEPTH]; \
+    bool check_result = false;                                                                      \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; i++){ /* Wait for the iteration on every core. */ \
+        while(__atomic_load_n(&slot[i].completed, __ATOMIC_ACQUIRE) != pipeline_state_##test_name.collected + 1){ \
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                               \
+            pipeline_state_##test_name.taken++;                                                     \
+        }                                                                                           \
+    }                                                                                               \
+    pipeline_state_##test_name.collected++;                                                         \
+    /* Take the notifications still due for the iterations collected (see above). */                \
+    while(pipeline_state_##test_name.taken <                                                        \
+            pipeline_state_##test_name.collected * RP2040config_testRUN_ON_CORES){                  \
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                                   \
+        pipeline_state_##test_name.taken++;                                                         \
+    }                                                                                               \
+    bool same_iteration = true;                                                                     \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; i++){                                             \
+        if(slot[i].iteration != iteration || slot[i].completed != iteration + 1){                   \
+            same_iteration = false;                                                                 \
+        }                                                                                           \
+        return_info_slaves_##test_name[i].return_value = slot[i].return_value;                      \
+        return_info_slaves_##test_name[i].return_time = slot[i].return_time;                        \
+    }                                                                                               \
+    if(same_iteration){                                                                             \
+        CHECK_GENERATION(check_function, slot)                                                      \
+        ADD_CHECK_ERRORS(test_name, slot)                                                           \
+    }                                                                                               \
+    if(check_result){                                                                               \
+        output = slot[0].return_value; /* If successful, return the first value */                  \
+        outcome = true;                                                                             \
+    } else {                                                                                        \
+        output = (__typeof__(output)){0};                                                           \
+        outcome = false;                                                                            \
+    }                                                                                               \
+}                                                                                                   \
+
 /** Function used to receive the output from the slaves:
 
     test_name:      the name of the test.
@@ -415,15 +1858,15 @@ for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){
 */
 #define receive_output_from_slaves(test_name, check_function, output, outcome)                      \
 bool check_result = false;                                                                          \
-for (int i = 0; i<RP2040config_testRUN_ON_CORES; i++) { /* Wait for the tasks to finish. */         \
-    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);                                                       \
-}                                                                                                   \
-CHECK_GENERATION(check_function, return_info_slaves)  /* Check on returned values*/                 \
+completion_barrier_wait(&completion_##test_name); /* Wait for the tasks to finish. */               \
+CHECK_GENERATION(check_function, return_info_slaves_##test_name)  /* Check on returned values*/     \
+ADD_CHECK_ERRORS(test_name, return_info_slaves_##test_name)                                         \
+FAULT_RECORD(test_name, check_result)                                                               \
 if(check_result){                                                                                   \
-    output = return_info_slaves[0].return_value; /* If successful, return the first value */        \
+    output = return_info_slaves_##test_name[0].return_value; /* If successful, return the first value */ \
     outcome = true;                                                                                 \
 } else {                                                                                            \
-    output = 0;                                                                                     \
+    output = (__typeof__(output)){0};                                                               \
     outcome = false;                                                                                \
 }                                                                                                   \
 
@@ -440,16 +1883,37 @@ should_continue##test_name=false; /* Set the master to exit*/
     one of the slave tasks + 1.
 
     Moreover it saves the return handle in a shared variable, used for notifying that the slaves 
-    have terminated their execution.
+    have terminated their execution. The handle is written before the master can run: when the
+    scheduler is already running (start_test_runner) its slaves may notify it at once.
 */
 
 #define start_master(test_name)      \
-xTaskCreate(vMasterFunction_##test_name,    \
+create_task(vMasterFunction_##test_name, \
     "vMasterFunction"STRING(test_name),     \
-    RP2040config_tskMASTER_STACK_SIZE,      \
+    STACK_MASTER_SIZE(test_name),           \
     NULL,                                   \
     RP2040config_tskMASTER_PRIORITY,        \
-    &masterTaskHandle_##test_name);         \
+    &masterTaskHandle_##test_name,          \
+    TASK_STORAGE(master_storage_##test_name, 0)); \
+
+/**
+    Places the descriptor of the test in the registry (see LibraryFreeRTOS_RP2040Registry.h),
+    so that start_test_runner can start it instead of start_master. Used by every validator.
+*/
+
+#define REGISTER_TEST(test_name)                                                                     \
+static void start_test_##test_name(void){                                                            \
+    start_master(test_name);                                                                         \
+}                                                                                                    \
+static const struct test_descriptor test_descriptor_##test_name TEST_DESCRIPTOR_ATTRIBUTES = {       \
+    STRING(test_name), start_test_##test_name, &test_state_##test_name                               \
+};                                                                                                   \
+
+/*
+    Group of the test for TEST_RUN_GROUPS, to be set before the scheduler is started.
+*/
+#define configure_test_group(test_name, group_)                                                      \
+    test_state_##test_name.group = (group_);                                                         \
 
 
 
@@ -0,0 +1,125 @@
+/*
+
+Completion barrier: a waiter (the master) blocks until all the parties (its slaves or workers)
+have completed a round of work, woken up once per round instead of once per party.
+
+With RP2040config_USE_COMPLETION_BARRIER the parties decrement a counter of pending arrivals under
+a hardware spin lock (the M0+ has no atomic read-modify-write), and only the last one rings the
+doorbell of the waiter (see LibraryFreeRTOS_RP2040Transport.h). The waiter polls the doorbell
+RP2040config_BARRIER_SPIN times, then blocks on its notification: it is notified only if it has
+blocked, so a waiter still spinning is released without the kernel.
+
+Otherwise every party notifies the waiter, which takes one notification per party: up to one
+wake-up (and one pass through the scheduler) per party and round. Every notification of the
+waiter is then taken as an arrival, so no other notification may be pending when it waits.
+
+Both count the times the waiter has blocked (completion_barrier_blocks), so that the two can be
+compared per round. The barrier is reused round after round: the last arrival rearms it before
+waking the waiter, and the parties cannot arrive again before the waiter has dispatched them.
+
+The waiter must not expect its notification count to be exact after a wait on the barrier:
+a ring may notify it after it has seen the ring, so its next wait on a notification may be spurious.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_BARRIER_H
+#define LIBRARY_FREE_RTOS_RP2040_BARRIER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "LibraryFreeRTOS_RP2040Transport.h"
+#include "hardware/sync.h"
+#include <stdint.h>
+
+struct completion_barrier{
+    TaskHandle_t waiter;
+    uint32_t parties;
+    uint32_t rounds;        /* Rounds waited. */
+#if RP2040config_USE_COMPLETION_BARRIER
+    spin_lock_t *lock;      /* Striped: shared with other short critical sections, never nested. */
+    uint32_t pending;       /* Parties not arrived yet in this round, under lock. */
+    struct doorbell done;   /* Rung by the last arrival. */
+#else
+    uint32_t blocks;
+#endif
+};
+
+/*
+    Arms the barrier for parties arrivals per round, waited by waiter. It must be called
+    before any party can arrive.
+*/
+
+static inline void completion_barrier_init(struct completion_barrier *barrier, uint32_t parties, TaskHandle_t waiter){
+    barrier->waiter = waiter;
+    barrier->parties = parties;
+    barrier->rounds = 0;
+#if RP2040config_USE_COMPLETION_BARRIER
+    if(barrier->lock == NULL){
+        barrier->lock = spin_lock_instance(next_striped_spin_lock_num());
+    }
+    barrier->pending = parties;
+    doorbell_init(&barrier->done, waiter);
+#else
+    barrier->blocks = 0;
+#endif
+}
+
+/*
+    Party side: the work of this round is complete. The memory written before it is visible
+    to the waiter once its wait has returned.
+*/
+
+static inline void completion_barrier_arrive(struct completion_barrier *barrier){
+#if RP2040config_USE_COMPLETION_BARRIER
+    uint32_t saved = spin_lock_blocking(barrier->lock);
+    bool last = --barrier->pending == 0;
+    if(last){
+        barrier->pending = barrier->parties;
+    }
+    spin_unlock(barrier->lock, saved);
+    if(last){
+        doorbell_ring(&barrier->done);   /* Outside the lock: it may enter the kernel. */
+    }
+#else
+    xTaskNotifyGive(barrier->waiter);
+#endif
+}
+
+/*
+    Waiter side: blocks until every party has arrived in this round.
+*/
+
+static inline void completion_barrier_wait(struct completion_barrier *barrier){
+#if RP2040config_USE_COMPLETION_BARRIER
+    doorbell_wait(&barrier->done, RP2040config_BARRIER_SPIN);
+#else
+    for(uint32_t i=0; i<barrier->parties; ++i){
+        if(ulTaskNotifyTake(pdFALSE, 0) == 0){    /* Count the takes which block. */
+            barrier->blocks++;
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        }
+    }
+#endif
+    barrier->rounds++;
+}
+
+/*
+    Times the waiter has blocked on the barrier (each one ended by a wake-up).
+*/
+
+static inline uint32_t completion_barrier_blocks(const struct completion_barrier *barrier){
+#if RP2040config_USE_COMPLETION_BARRIER
+    return barrier->done.blocks;
+#else
+    return barrier->blocks;
+#endif
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+
+Single-producer/multi-consumer broadcast channel.
+
+The producer (the master) publishes one immutable payload and every reader (one slave per core)
+reads it in place, instead of receiving its own copy.
+
+Each payload lives in one of RP2040config_BROADCAST_SLOTS slots, tagged with a sequence number.
+A slot can be reused by the producer only when all the RP2040config_testRUN_ON_CORES readers
+have acknowledged it.
+
+The Cortex-M0+ has no atomic read-modify-write instruction (no LDREX/STREX), so the reference
+count of a slot is not a single shared counter: every reader owns an acknowledge word, written
+only by itself, and the count of pending readers is the number of words lagging behind the
+sequence of the slot. Only aligned 32-bit loads/stores and memory barriers are needed, so the
+channel is lock-free on the RP2040 and does not depend on FreeRTOS (it can be tested with pthreads).
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_BROADCAST_H
+#define LIBRARY_FREE_RTOS_RP2040_BROADCAST_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+struct broadcast_slot{
+    uint32_t sequence;                                  /* Sequence of the payload stored, 0 if never published. */
+    uint32_t acks[RP2040config_testRUN_ON_CORES];       /* Last sequence acknowledged by each reader. */
+    uint32_t size;                                      /* Size of the payload published. */
+    void *payload;
+};
+
+struct broadcast_channel{
+    struct broadcast_slot slots[RP2040config_BROADCAST_SLOTS];
+    uint32_t published;                                 /* Last sequence published (written by the producer only). */
+    uint32_t next[RP2040config_testRUN_ON_CORES];       /* Next sequence to read (each written by its reader only). */
+};
+
+/*
+    Initializes the channel.
+
+    storage must hold RP2040config_BROADCAST_SLOTS payloads of payload_size bytes.
+*/
+
+static inline void broadcast_init(struct broadcast_channel *channel, void *storage, size_t payload_size){
+    for(int i=0; i<RP2040config_BROADCAST_SLOTS; ++i){
+        channel->slots[i].sequence = 0;
+        channel->slots[i].size = 0;
+        channel->slots[i].payload = (char *) storage + i*payload_size;
+        for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){
+            channel->slots[i].acks[j] = 0;
+        }
+    }
+    channel->published = 0;
+    for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){
+        channel->next[j] = 1;
+    }
+}
+
+/*
+    Returns the number of readers which still have to acknowledge the slot (its reference count).
+*/
+
+static inline uint32_t broadcast_pending_readers(struct broadcast_slot *slot){
+    uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    uint32_t pending = 0;
+    for(int j=0; j<RP2040config_testRUN_ON_CORES; ++j){
+        if(__atomic_load_n(&slot->acks[j], __ATOMIC_ACQUIRE) != sequence){
+            pending++;
+        }
+    }
+    return pending;
+}
+
+/*
+    Producer side: returns the payload area of the next slot to publish,
+    or NULL if its previous content has not been released by all the readers yet.
+*/
+
+static inline void *broadcast_acquire(struct broadcast_channel *channel){
+    struct broadcast_slot *slot = &channel->slots[(channel->published + 1) % RP2040config_BROADCAST_SLOTS];
+    if(broadcast_pending_readers(slot) != 0){
+        return NULL;
+    }
+    return slot->payload;
+}
+
+/*
+    Producer side: makes the payload written in the area returned by broadcast_acquire visible
+    to the readers. Returns the sequence number assigned to it.
+*/
+
+static inline uint32_t broadcast_publish(struct broadcast_channel *channel, size_t size){
+    uint32_t sequence = channel->published + 1;
+    struct broadcast_slot *slot = &channel->slots[sequence % RP2040config_BROADCAST_SLOTS];
+    slot->size = (uint32_t) size;
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+    channel->published = sequence;
+    return sequence;
+}
+
+/*
+    Reader side: returns a pointer to the next payload for the reader (in place, read only),
+    or NULL if it has not been published yet. size (if not NULL) receives its size.
+*/
+
+static inline const void *broadcast_read(struct broadcast_channel *channel, int reader, size_t *size){
+    uint32_t sequence = channel->next[reader];
+    struct broadcast_slot *slot = &channel->slots[sequence % RP2040config_BROADCAST_SLOTS];
+    if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence){
+        return NULL;
+    }
+    if(size != NULL){
+        *size = slot->size;
+    }
+    return slot->payload;
+}
+
+/*
+    Reader side: acknowledges the payload returned by the last broadcast_read,
+    which must not be accessed anymore.
+*/
+
+static inline void broadcast_release(struct broadcast_channel *channel, int reader){
+    uint32_t sequence = channel->next[reader];
+    struct broadcast_slot *slot = &channel->slots[sequence % RP2040config_BROADCAST_SLOTS];
+    __atomic_store_n(&slot->acks[reader], sequence, __ATOMIC_RELEASE);
+    channel->next[reader] = sequence + 1;
+}
+
+#endif
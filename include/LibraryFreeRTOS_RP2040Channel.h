@@ -0,0 +1,239 @@
+/*
+
+Channels of uint32_t samples from one or more producer tasks to a consumer task
+(see TestQueue and TestChannel), with interchangeable backends selected by RP2040config_CHANNEL:
+
+- RP2040_CHANNEL_QUEUE      : a queue (xQueueCreate). Every send and receive takes the lock of the
+                              queue and copies the sample; any number of producers.
+- RP2040_CHANNEL_STREAM     : a stream buffer (xStreamBufferCreate) of 4-byte samples, woken up at
+                              every sample (trigger level of one sample). One producer.
+- RP2040_CHANNEL_MESSAGE    : a message buffer (xMessageBufferCreate), one message per sample, which
+                              stores its length too. One producer.
+- RP2040_CHANNEL_RING       : a lock-free single-producer/single-consumer ring in memory. Each side
+                              blocks (on an empty or full ring) through a doorbell
+                              (see LibraryFreeRTOS_RP2040Transport.h) after polling it
+                              RP2040config_CHANNEL_SPIN times, so it needs the kernel only when the
+                              other side is blocked. One producer.
+- RP2040_CHANNEL_QUEUE_SET  : a queue per producer, gathered in a queue set: the consumer selects
+                              the queue holding a sample, then receives it. Up to
+                              RP2040config_CHANNEL_MAX_PRODUCERS producers, which never share a lock.
+
+Every backend holds RP2040config_CHANNEL_LENGTH samples (per producer with RP2040_CHANNEL_QUEUE_SET).
+The samples of each producer are received in the order they have been sent.
+
+With RP2040config_USE_STATIC_ALLOCATION the kernel objects are created with the *CreateStatic
+variants in storage held by struct sample_channel, so the channel takes nothing from the heap.
+
+The ring blocks without a timeout (any timeout but 0 waits forever), on the notification of the
+blocked task: the producer and the consumer must not wait for other notifications meanwhile.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_CHANNEL_H
+#define LIBRARY_FREE_RTOS_RP2040_CHANNEL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "LibraryFreeRTOS_RP2040Transport.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE
+#define CHANNEL_NAME "queue"
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_STREAM
+#define CHANNEL_NAME "stream"
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_MESSAGE
+#define CHANNEL_NAME "message"
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_RING
+#define CHANNEL_NAME "ring"
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE_SET
+#define CHANNEL_NAME "queue_set"
+#else
+#error "Unknown RP2040config_CHANNEL"
+#endif
+
+struct sample_channel{
+    uint32_t producers;
+#if RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE
+    QueueHandle_t queue;
+#if RP2040config_USE_STATIC_ALLOCATION
+    uint8_t queue_storage[RP2040config_CHANNEL_LENGTH*sizeof(uint32_t)];
+    StaticQueue_t queue_buffer;
+#endif
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_STREAM
+    StreamBufferHandle_t stream;
+#if RP2040config_USE_STATIC_ALLOCATION
+    /* One byte more: a static stream buffer of N bytes holds N-1 of them (xStreamBufferCreate adds it). */
+    uint8_t stream_storage[RP2040config_CHANNEL_LENGTH*sizeof(uint32_t) + 1];
+    StaticStreamBuffer_t stream_buffer;
+#endif
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_MESSAGE
+    MessageBufferHandle_t messages;
+#if RP2040config_USE_STATIC_ALLOCATION
+    uint8_t messages_storage[RP2040config_CHANNEL_LENGTH*(sizeof(uint32_t) + sizeof(size_t)) + 1];    /* As above. */
+    StaticMessageBuffer_t messages_buffer;
+#endif
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_RING
+    uint32_t samples[RP2040config_CHANNEL_LENGTH];
+    /* The samples pushed are counted by the rings of filled (written by the producer only),
+       the samples popped by the rings of drained (written by the consumer only). */
+    struct doorbell filled;     /* From the producer to the consumer. */
+    struct doorbell drained;    /* From the consumer to the producer, waited only on a full ring. */
+#else
+    QueueHandle_t queues[RP2040config_CHANNEL_MAX_PRODUCERS];
+    QueueSetHandle_t set;
+#if RP2040config_USE_STATIC_ALLOCATION
+    uint8_t queues_storage[RP2040config_CHANNEL_MAX_PRODUCERS][RP2040config_CHANNEL_LENGTH*sizeof(uint32_t)];
+    StaticQueue_t queues_buffer[RP2040config_CHANNEL_MAX_PRODUCERS];
+    uint8_t set_storage[RP2040config_CHANNEL_MAX_PRODUCERS*RP2040config_CHANNEL_LENGTH*sizeof(QueueSetMemberHandle_t)];
+    StaticQueue_t set_buffer;
+#endif
+#endif
+};
+
+/*
+    Creates the channel for the given number of producers, before it is used by either side.
+    It returns false if the kernel objects cannot be allocated, or if the backend does not
+    support that many producers. With static allocation the channel must not be moved
+    once created, since the kernel objects live inside it.
+*/
+
+static inline bool sample_channel_init(struct sample_channel *channel, uint32_t producers){
+    channel->producers = producers;
+#if RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE
+#if RP2040config_USE_STATIC_ALLOCATION
+    channel->queue = xQueueCreateStatic(RP2040config_CHANNEL_LENGTH, sizeof(uint32_t),
+        channel->queue_storage, &channel->queue_buffer);
+#else
+    channel->queue = xQueueCreate(RP2040config_CHANNEL_LENGTH, sizeof(uint32_t));
+#endif
+    return channel->queue != NULL;
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_STREAM
+    /* Whole samples only: the free space is always a multiple of a sample. */
+#if RP2040config_USE_STATIC_ALLOCATION
+    channel->stream = xStreamBufferCreateStatic(sizeof(channel->stream_storage), sizeof(uint32_t),
+        channel->stream_storage, &channel->stream_buffer);
+#else
+    channel->stream = xStreamBufferCreate(RP2040config_CHANNEL_LENGTH*sizeof(uint32_t), sizeof(uint32_t));
+#endif
+    return producers == 1 && channel->stream != NULL;
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_MESSAGE
+#if RP2040config_USE_STATIC_ALLOCATION
+    channel->messages = xMessageBufferCreateStatic(sizeof(channel->messages_storage),
+        channel->messages_storage, &channel->messages_buffer);
+#else
+    channel->messages = xMessageBufferCreate(RP2040config_CHANNEL_LENGTH*(sizeof(uint32_t) + sizeof(size_t)));
+#endif
+    return producers == 1 && channel->messages != NULL;
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_RING
+    doorbell_init(&channel->filled, NULL);  /* Bound to each side when it first blocks. */
+    doorbell_init(&channel->drained, NULL);
+    return producers == 1;
+#else
+    if(producers == 0 || producers > RP2040config_CHANNEL_MAX_PRODUCERS){
+        return false;
+    }
+#if RP2040config_USE_STATIC_ALLOCATION
+    channel->set = xQueueCreateSetStatic(producers*RP2040config_CHANNEL_LENGTH,
+        channel->set_storage, &channel->set_buffer);
+#else
+    channel->set = xQueueCreateSet(producers*RP2040config_CHANNEL_LENGTH);
+#endif
+    if(channel->set == NULL){
+        return false;
+    }
+    for(uint32_t i=0; i<producers; ++i){
+#if RP2040config_USE_STATIC_ALLOCATION
+        channel->queues[i] = xQueueCreateStatic(RP2040config_CHANNEL_LENGTH, sizeof(uint32_t),
+            channel->queues_storage[i], &channel->queues_buffer[i]);
+#else
+        channel->queues[i] = xQueueCreate(RP2040config_CHANNEL_LENGTH, sizeof(uint32_t));
+#endif
+        if(channel->queues[i] == NULL || xQueueAddToSet(channel->queues[i], channel->set) != pdPASS){
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+/*
+    Producer side: sends the sample of the given producer (from 0 to producers-1), waiting at most
+    timeout ticks for some space. It returns false if the channel is still full.
+*/
+
+static inline bool sample_channel_send(struct sample_channel *channel, uint32_t producer, uint32_t sample, TickType_t timeout){
+#if RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE
+    (void) producer;
+    return xQueueSendToBack(channel->queue, &sample, timeout) == pdPASS;
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_STREAM
+    (void) producer;
+    return xStreamBufferSend(channel->stream, &sample, sizeof(sample), timeout) == sizeof(sample);
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_MESSAGE
+    (void) producer;
+    return xMessageBufferSend(channel->messages, &sample, sizeof(sample), timeout) == sizeof(sample);
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_RING
+    (void) producer;
+    while(true){
+        uint32_t drained = __atomic_load_n(&channel->drained.rung, __ATOMIC_ACQUIRE);
+        if(channel->filled.rung - drained < RP2040config_CHANNEL_LENGTH){
+            break;
+        }
+        if(timeout == 0){
+            return false;
+        }
+        /* The consumer rings drained at every receive, but the producer answers only here:
+           skip the rings already seen, so that the wait lasts until the next slot is freed. */
+        channel->drained.answered = drained;
+        channel->drained.receiver = xTaskGetCurrentTaskHandle();
+        doorbell_wait(&channel->drained, RP2040config_CHANNEL_SPIN);
+    }
+    channel->samples[channel->filled.rung % RP2040config_CHANNEL_LENGTH] = sample;
+    doorbell_ring(&channel->filled);    /* Publishes the sample. */
+    return true;
+#else
+    return xQueueSendToBack(channel->queues[producer], &sample, timeout) == pdPASS;
+#endif
+}
+
+/*
+    Consumer side: receives a sample, waiting at most timeout ticks for one.
+    It returns false if the channel is still empty.
+*/
+
+static inline bool sample_channel_receive(struct sample_channel *channel, uint32_t *sample, TickType_t timeout){
+#if RP2040config_CHANNEL == RP2040_CHANNEL_QUEUE
+    return xQueueReceive(channel->queue, sample, timeout) == pdPASS;
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_STREAM
+    return xStreamBufferReceive(channel->stream, sample, sizeof(*sample), timeout) == sizeof(*sample);
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_MESSAGE
+    return xMessageBufferReceive(channel->messages, sample, sizeof(*sample), timeout) == sizeof(*sample);
+#elif RP2040config_CHANNEL == RP2040_CHANNEL_RING
+    uint32_t tail = channel->filled.answered;
+    if(!doorbell_answer(&channel->filled)){
+        if(timeout == 0){
+            return false;
+        }
+        channel->filled.receiver = xTaskGetCurrentTaskHandle();
+        doorbell_wait(&channel->filled, RP2040config_CHANNEL_SPIN);
+    }
+    *sample = channel->samples[tail % RP2040config_CHANNEL_LENGTH];
+    doorbell_ring(&channel->drained);   /* Frees the slot. */
+    return true;
+#else
+    QueueSetMemberHandle_t member = xQueueSelectFromSet(channel->set, timeout);
+    return member != NULL && xQueueReceive((QueueHandle_t) member, sample, 0) == pdPASS;
+#endif
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*
+
+Comparators of the results of the cores, selected by the type of the results.
+
+- BITWISE_CHECK(a, b)   : same bytes (memcmp), for any type. Structures must not have padding,
+                          or be fully cleared (memset) before their fields are assigned.
+- ULP_CHECK(a, b)       : float or double at most RP2040config_CHECK_MAX_ULP units in the last
+                          place apart (the number of representable values between them, so
+                          -0.0 and +0.0 are equal and a NaN only matches the same NaN).
+- EPSILON_CHECK(a, b)   : float or double with |a-b| <= RP2040config_CHECK_EPSILON * max(|a|,|b|).
+                          A NaN never matches.
+- GENERIC_CHECK(a, b)   : float and double compared as selected by RP2040config_CHECK_FLOAT
+                          (RP2040_CHECK_BITWISE, RP2040_CHECK_ULP or RP2040_CHECK_EPSILON), any other
+                          type (integers, structures) bitwise. It is DEFAULT_CHECK.
+
+A structure can be compared field by field composing them, e.g.
+
+    static bool check_sample(struct sample a, struct sample b){
+        return GENERIC_CHECK(a.channel, b.channel) && ULP_CHECK(a.value, b.value);
+    }
+
+CHECK_ERROR(a, b) is the size of the difference between two results, whatever comparator is
+used: the distance in ULP for float and double (UINT64_MAX when either is a NaN or an infinity,
+unless both have the same bits), |a-b| for integers, and the number of bits which differ for
+any other type (structures), where no distance is defined.
+The validators keep its maximum and mean over all the comparisons (check_errors_print), to
+choose how much precision a faster kernel can give up.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_COMPARE_H
+#define LIBRARY_FREE_RTOS_RP2040_COMPARE_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+    Position of the value on a line where the consecutive floating point values are consecutive
+    integers (the negative values are stored as sign and magnitude).
+*/
+
+static inline int64_t compare_float_ordinal(float value){
+    int32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? (int64_t) INT32_MIN - bits : bits;
+}
+
+static inline int64_t compare_double_ordinal(double value){
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? INT64_MIN - bits : bits;
+}
+
+/*
+    Distance in ULP. A NaN or an infinity is not on the line: it is at no distance from the
+    same bits, and at UINT64_MAX from anything else.
+*/
+
+static inline uint64_t compare_ulp_float(float a, float b){
+    if(!__builtin_isfinite(a) || !__builtin_isfinite(b)){
+        return memcmp(&a, &b, sizeof(a)) == 0 ? 0 : UINT64_MAX;
+    }
+    int64_t x = compare_float_ordinal(a), y = compare_float_ordinal(b);
+    return x > y ? (uint64_t) (x - y) : (uint64_t) (y - x);
+}
+
+static inline uint64_t compare_ulp_double(double a, double b){
+    if(!__builtin_isfinite(a) || !__builtin_isfinite(b)){
+        return memcmp(&a, &b, sizeof(a)) == 0 ? 0 : UINT64_MAX;
+    }
+    uint64_t x = (uint64_t) compare_double_ordinal(a), y = (uint64_t) compare_double_ordinal(b);
+    return (int64_t) x > (int64_t) y ? x - y : y - x;  /* The difference can exceed INT64_MAX. */
+}
+
+/*
+    |a-b| between the integers of size bytes at a and at b, signed or unsigned.
+*/
+
+static inline int64_t compare_signed_value(const void *value, size_t size){
+    int8_t v8;
+    int16_t v16;
+    int32_t v32;
+    int64_t v64;
+    switch(size){
+        case 1: memcpy(&v8, value, 1); return v8;
+        case 2: memcpy(&v16, value, 2); return v16;
+        case 4: memcpy(&v32, value, 4); return v32;
+        default: memcpy(&v64, value, 8); return v64;
+    }
+}
+
+static inline uint64_t compare_unsigned_value(const void *value, size_t size){
+    uint8_t v8;
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
+    switch(size){
+        case 1: memcpy(&v8, value, 1); return v8;
+        case 2: memcpy(&v16, value, 2); return v16;
+        case 4: memcpy(&v32, value, 4); return v32;
+        default: memcpy(&v64, value, 8); return v64;
+    }
+}
+
+static inline uint64_t compare_signed(const void *a, const void *b, size_t size){
+    int64_t x = compare_signed_value(a, size), y = compare_signed_value(b, size);
+    return x > y ? (uint64_t) x - (uint64_t) y : (uint64_t) y - (uint64_t) x;
+}
+
+static inline uint64_t compare_unsigned(const void *a, const void *b, size_t size){
+    uint64_t x = compare_unsigned_value(a, size), y = compare_unsigned_value(b, size);
+    return x > y ? x - y : y - x;
+}
+
+/*
+    Number of bits which differ between the size bytes at a and at b.
+*/
+
+static inline uint64_t compare_bits(const void *a, const void *b, size_t size){
+    uint64_t bits = 0;
+    for(size_t i=0; i<size; ++i){
+        bits += (uint64_t) __builtin_popcount(((const uint8_t *) a)[i] ^ ((const uint8_t *) b)[i]);
+    }
+    return bits;
+}
+
+static inline bool check_ulp_float(float a, float b){
+    return compare_ulp_float(a, b) <= RP2040config_CHECK_MAX_ULP;
+}
+
+static inline bool check_ulp_double(double a, double b){
+    return compare_ulp_double(a, b) <= RP2040config_CHECK_MAX_ULP;
+}
+
+static inline bool check_epsilon_double(double a, double b){
+    double difference = a > b ? a - b : b - a;
+    double magnitude_a = a < 0 ? -a : a;
+    double magnitude_b = b < 0 ? -b : b;
+    return a == b || difference <= RP2040config_CHECK_EPSILON * (magnitude_a > magnitude_b ? magnitude_a : magnitude_b);
+}
+
+static inline bool check_epsilon_float(float a, float b){
+    return check_epsilon_double(a, b);
+}
+
+/*
+    Comparators and errors of GENERIC_CHECK and CHECK_ERROR, on the addresses of the values.
+*/
+
+static inline bool check_bytes(const void *a, const void *b, size_t size){
+    return memcmp(a, b, size) == 0;
+}
+
+static inline bool check_float(const void *a, const void *b, size_t size){
+#if RP2040config_CHECK_FLOAT == RP2040_CHECK_ULP
+    (void) size;
+    return check_ulp_float(*(const float *) a, *(const float *) b);
+#elif RP2040config_CHECK_FLOAT == RP2040_CHECK_EPSILON
+    (void) size;
+    return check_epsilon_float(*(const float *) a, *(const float *) b);
+#else
+    return check_bytes(a, b, size);
+#endif
+}
+
+static inline bool check_double(const void *a, const void *b, size_t size){
+#if RP2040config_CHECK_FLOAT == RP2040_CHECK_ULP
+    (void) size;
+    return check_ulp_double(*(const double *) a, *(const double *) b);
+#elif RP2040config_CHECK_FLOAT == RP2040_CHECK_EPSILON
+    (void) size;
+    return check_epsilon_double(*(const double *) a, *(const double *) b);
+#else
+    return check_bytes(a, b, size);
+#endif
+}
+
+static inline uint64_t check_error_float(const void *a, const void *b, size_t size){
+    (void) size;
+    return compare_ulp_float(*(const float *) a, *(const float *) b);
+}
+
+static inline uint64_t check_error_double(const void *a, const void *b, size_t size){
+    (void) size;
+    return compare_ulp_double(*(const double *) a, *(const double *) b);
+}
+
+#define ULP_CHECK(a, b)                                                                         \
+    _Generic((a), float: check_ulp_float, double: check_ulp_double)((a), (b))
+
+#define EPSILON_CHECK(a, b)                                                                     \
+    _Generic((a), float: check_epsilon_float, double: check_epsilon_double)((a), (b))
+
+/* The values are copied, so that b is converted to the type of a and both have an address. */
+#define GENERIC_COMPARE(a, b, float_function, double_function, default_function)               \
+    ({                                                                                          \
+        __typeof__(a) compare_a = (a);                                                          \
+        __typeof__(a) compare_b = (b);                                                          \
+        _Generic(compare_a,                                                                     \
+            float: float_function,                                                              \
+            double: double_function,                                                            \
+            default: default_function)(&compare_a, &compare_b, sizeof(compare_a));              \
+    })
+
+#define BITWISE_CHECK(a, b) GENERIC_COMPARE(a, b, check_bytes, check_bytes, check_bytes)
+#define GENERIC_CHECK(a, b) GENERIC_COMPARE(a, b, check_float, check_double, check_bytes)
+
+/* Selects by the type of value: signed integers, unsigned integers or any other type (default). */
+#define CHECK_ERROR_INTEGER(value, signed_function, unsigned_function, default_function)        \
+    _Generic((value),                                                                           \
+        char: (char) -1 < 0 ? signed_function : unsigned_function,                              \
+        signed char: signed_function,                                                           \
+        short: signed_function,                                                                 \
+        int: signed_function,                                                                   \
+        long: signed_function,                                                                  \
+        long long: signed_function,                                                             \
+        bool: unsigned_function,                                                                \
+        unsigned char: unsigned_function,                                                       \
+        unsigned short: unsigned_function,                                                      \
+        unsigned int: unsigned_function,                                                        \
+        unsigned long: unsigned_function,                                                       \
+        unsigned long long: unsigned_function,                                                  \
+        default: default_function)                                                              \
+
+#define CHECK_ERROR(a, b)                                                                       \
+    GENERIC_COMPARE(a, b, check_error_float, check_error_double,                                \
+        CHECK_ERROR_INTEGER(a, compare_signed, compare_unsigned, compare_bits))
+
+/* Unit of CHECK_ERROR for the type of value. */
+#define CHECK_ERROR_UNIT(value)                                                                 \
+    _Generic((value), float: "ulp", double: "ulp",                                              \
+        default: CHECK_ERROR_INTEGER(value, "|a-b|", "|a-b|", "bits"))
+
+/*
+    Size of the differences found by the comparisons of a test.
+*/
+
+struct check_errors{
+    uint32_t count;
+    uint64_t max;
+    uint64_t total;         /* Saturated. */
+    const char *unit;
+};
+
+static inline void check_errors_add(struct check_errors *errors, uint64_t error, const char *unit){
+    errors->count++;
+    if(error > errors->max){
+        errors->max = error;
+    }
+    errors->total = errors->total + error < errors->total ? UINT64_MAX : errors->total + error;
+    errors->unit = unit;
+}
+
+/*
+    Prints the maximum and the mean error, when some comparison has found a difference
+    or the results are floating point.
+*/
+
+static inline void check_errors_print(const char *test_name, const struct check_errors *errors){
+    if(errors->count == 0 || (errors->max == 0 && strcmp(errors->unit, "ulp") != 0)){
+        return;
+    }
+    uint64_t mean = errors->total / errors->count;
+    uint64_t hundredths = (errors->total % errors->count) * 100 / errors->count;
+    printf("%s> check_error:\t n=%lu max=%llu mean=%llu.%02llu %s\n", test_name,
+        (unsigned long) errors->count, (unsigned long long) errors->max,
+        (unsigned long long) mean, (unsigned long long) hundredths, errors->unit);
+}
+
+#endif
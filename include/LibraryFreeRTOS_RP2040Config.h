@@ -26,10 +26,358 @@ NB: due to the RT scheduling algorithm, the test procedure terminates correctly
 only if tskMASTER_PRIORITY > tskSLAVE_PRIORITY
 */
 
+/*
+The next two options are also read by FreeRTOSConfig.h, so their defaults come before it is included.
+The kernel sources include FreeRTOSConfig.h without this file: to change them, pass them with -D
+(target_compile_definitions, as test_fault_static does) rather than editing the defaults.
+*/
+
+/*
+If set to 1 the tasks of the library (masters, slaves, workers, replicas, telemetry drain) are
+created with xTaskCreateStatic in storage declared with each test, so that they take nothing from
+the FreeRTOS heap and their RAM is reported at link time (see ram_report.py).
+The slaves of the function validators must be kept alive: a static TCB cannot be reused
+until the idle task has cleaned up the task deleted in it.
+*/
+#ifndef RP2040config_USE_STATIC_ALLOCATION
+#define RP2040config_USE_STATIC_ALLOCATION 0
+#endif
+
+/*
+If set to 1 the scheduler is traced (see LibraryFreeRTOS_RP2040Profiler.h): every
+RP2040config_PROFILER_PERIOD ticks a low-priority task prints the idle time and the context
+switches of each core, and the run time and the notify-to-wake latency of each task.
+At most RP2040config_PROFILER_MAX_TASKS tasks are followed, through their thread local storage
+pointer RP2040config_PROFILER_TLS_INDEX.
+*/
+#ifndef RP2040config_USE_PROFILER
+#define RP2040config_USE_PROFILER 0
+#endif
+
 // If needed can use default configurations taken from here
 #include "FreeRTOSConfig.h"
 
 #define RP2040config_tskSLAVE_STACK_SIZE  configMINIMAL_STACK_SIZE
 #define RP2040config_tskMASTER_STACK_SIZE configMINIMAL_STACK_SIZE
 
+/*
+If set to 1 the slaves of the function validators are created once and kept alive
+(one per core) for all the retries of the test. If set to 0 they are created and
+deleted at every execution, as in the original implementation.
+*/
+#ifndef RP2040config_USE_WORKER_POOL
+#define RP2040config_USE_WORKER_POOL 1
+#endif
+
+/*
+If set to 1 the validators also print, for every test, the stack sizes (words used by its master
+and slaves + RP2040config_STACK_MARGIN) as a line of LibraryFreeRTOS_RP2040Stacks.h
+(see LibraryFreeRTOS_RP2040Stack.h).
+*/
+#ifndef RP2040config_STACK_CALIBRATION
+#define RP2040config_STACK_CALIBRATION 0
+#endif
+
+#ifndef RP2040config_STACK_MARGIN
+#define RP2040config_STACK_MARGIN 32
+#endif
+
+/*
+Mode (0 sequential, 1 parallel, 2 by group) and filter (comma separated names, * as suffix)
+of the registered tests run by start_test_runner (see LibraryFreeRTOS_RP2040Registry.h).
+*/
+#ifndef RP2040config_TEST_RUN_MODE
+#define RP2040config_TEST_RUN_MODE 0
+#endif
+
+#ifndef RP2040config_TEST_FILTER
+#define RP2040config_TEST_FILTER ""
+#endif
+
+#if RP2040config_USE_STATIC_ALLOCATION && !RP2040config_USE_WORKER_POOL
+#error "RP2040config_USE_STATIC_ALLOCATION requires RP2040config_USE_WORKER_POOL"
+#endif
+
+/*
+Number of slots of the static ring used by prepare_input_for_slaves to store the copies
+of the input given to the slaves (each slot holds one copy per core).
+*/
+#ifndef RP2040config_INPUT_RING_SLOTS
+#define RP2040config_INPUT_RING_SLOTS 2
+#endif
+
+/*
+Number of slots of the broadcast channel used by publish_input_for_slaves
+(the master can publish an input while the slaves still read the previous ones).
+*/
+#ifndef RP2040config_BROADCAST_SLOTS
+#define RP2040config_BROADCAST_SLOTS 2
+#endif
+
+/*
+Maximum number of inputs that prepare_batch_for_slaves can hand to the slaves at once.
+Every slave stores a result and a time for each of them.
+*/
+#ifndef RP2040config_BATCH_SIZE
+#define RP2040config_BATCH_SIZE 8
+#endif
+
+/*
+Maximum number of iterations in flight in the pipelined mode of create_multicore_task_validator
+(2 means double buffering: the master prepares the next input while the slaves compute).
+*/
+#ifndef RP2040config_PIPELINE_DEPTH
+#define RP2040config_PIPELINE_DEPTH 2
+#endif
+
+/*
+Number of timed executions of the function validators, preceded by RP2040config_testWARMUP_RUNS
+untimed ones. return_time is reported per core as min, median, mean, p99, max and standard deviation.
+*/
+#ifndef RP2040config_testREPEAT_RUNS
+#define RP2040config_testREPEAT_RUNS 1
+#endif
+
+#ifndef RP2040config_testWARMUP_RUNS
+#define RP2040config_testWARMUP_RUNS 0
+#endif
+
+/*
+Default retry policy of create_multicore_function_validator when the cores disagree
+(see LibraryFreeRTOS_RP2040Retry.h): attempts per run (0 for no limit) and backoff between
+the attempts, doubling from RP2040config_RETRY_BACKOFF_TICKS up to RP2040config_RETRY_BACKOFF_MAX_TICKS.
+*/
+#ifndef RP2040config_RETRY_MAX_ATTEMPTS
+#define RP2040config_RETRY_MAX_ATTEMPTS 0
+#endif
+
+#ifndef RP2040config_RETRY_BACKOFF_TICKS
+#define RP2040config_RETRY_BACKOFF_TICKS 0
+#endif
+
+#ifndef RP2040config_RETRY_BACKOFF_MAX_TICKS
+#define RP2040config_RETRY_BACKOFF_MAX_TICKS 64
+#endif
+
+/*
+If set to 1 the validators inject faults (see LibraryFreeRTOS_RP2040Fault.h): in every attempt, with
+probability RP2040config_FAULT_RATE_PPM parts per million, one of RP2040config_FAULT_KINDS
+(1 flip a bit of a result, 2 flip a bit of an input, 4 delay a core by RP2040config_FAULT_DELAY_US),
+drawn from a PRNG seeded with RP2040config_FAULT_SEED. Kinds, rate and seed can be changed per test with configure_faults.
+*/
+#ifndef RP2040config_USE_FAULT_INJECTION
+#define RP2040config_USE_FAULT_INJECTION 0
+#endif
+
+#ifndef RP2040config_FAULT_KINDS
+#define RP2040config_FAULT_KINDS 7
+#endif
+
+#ifndef RP2040config_FAULT_RATE_PPM
+#define RP2040config_FAULT_RATE_PPM 10000
+#endif
+
+#ifndef RP2040config_FAULT_SEED
+#define RP2040config_FAULT_SEED 1
+#endif
+
+#ifndef RP2040config_FAULT_DELAY_US
+#define RP2040config_FAULT_DELAY_US 100
+#endif
+
+/*
+Alignment of the per-core slots of a sharded accumulator (see LibraryFreeRTOS_RP2040Sharded.h).
+The striped SRAM of the RP2040 interleaves the four banks word by word, so word-aligned slots
+are already in different banks; on the host every slot takes its own cache line.
+*/
+#ifndef RP2040config_SHARD_ALIGN
+#ifdef RP2040_HOST_BUILD
+#define RP2040config_SHARD_ALIGN 64
+#else
+#define RP2040config_SHARD_ALIGN 4
+#endif
+#endif
+
+/*
+Dual modular redundancy validator (create_multicore_dmr_validator): checkpoints stored per core
+and segment, and times a segment is rerun from the last agreed state before the test fails.
+*/
+#ifndef RP2040config_DMR_TRACE_SIZE
+#define RP2040config_DMR_TRACE_SIZE 32
+#endif
+
+#ifndef RP2040config_DMR_MAX_RETRIES
+#define RP2040config_DMR_MAX_RETRIES 3
+#endif
+
+/*
+Signals between the master and its slaves (see LibraryFreeRTOS_RP2040Transport.h): task notifications,
+or a lock-free FIFO polled RP2040config_TRANSPORT_SPIN times by the receiver before it blocks.
+*/
+#define RP2040_TRANSPORT_NOTIFY     0
+#define RP2040_TRANSPORT_FIFO       1
+
+#ifndef RP2040config_TRANSPORT
+#define RP2040config_TRANSPORT RP2040_TRANSPORT_NOTIFY
+#endif
+
+#ifndef RP2040config_TRANSPORT_SPIN
+#define RP2040config_TRANSPORT_SPIN 200
+#endif
+
+/*
+Completion of a round by the slaves (see LibraryFreeRTOS_RP2040Barrier.h): a barrier waking the
+master once, after polling it RP2040config_BARRIER_SPIN times (as much as the FIFO transport by
+default), or one notification per slave.
+*/
+#ifndef RP2040config_USE_COMPLETION_BARRIER
+#define RP2040config_USE_COMPLETION_BARRIER 1
+#endif
+
+#ifndef RP2040config_BARRIER_SPIN
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+#define RP2040config_BARRIER_SPIN RP2040config_TRANSPORT_SPIN
+#else
+#define RP2040config_BARRIER_SPIN 0
+#endif
+#endif
+
+/*
+Channel of samples between tasks (see LibraryFreeRTOS_RP2040Channel.h): backend, samples held
+(per producer with a queue set), producers of a queue set, and times the ring is polled before
+its side blocks.
+*/
+#define RP2040_CHANNEL_QUEUE        0
+#define RP2040_CHANNEL_STREAM       1
+#define RP2040_CHANNEL_MESSAGE      2
+#define RP2040_CHANNEL_RING         3
+#define RP2040_CHANNEL_QUEUE_SET    4
+
+#ifndef RP2040config_CHANNEL
+#define RP2040config_CHANNEL RP2040_CHANNEL_QUEUE
+#endif
+
+#ifndef RP2040config_CHANNEL_LENGTH
+#define RP2040config_CHANNEL_LENGTH 100
+#endif
+
+#ifndef RP2040config_CHANNEL_MAX_PRODUCERS
+#define RP2040config_CHANNEL_MAX_PRODUCERS 4
+#endif
+
+#ifndef RP2040config_CHANNEL_SPIN
+#define RP2040config_CHANNEL_SPIN 200
+#endif
+
+/*
+Buffer validator (create_multicore_buffer_validator): bytes of the chunks hashed separately
+(see LibraryFreeRTOS_RP2040Digest.h), and the number of chunks of a buffer, which must hold
+at most RP2040config_DIGEST_CHUNK_SIZE * RP2040config_DIGEST_MAX_CHUNKS bytes.
+*/
+#ifndef RP2040config_DIGEST_CHUNK_SIZE
+#define RP2040config_DIGEST_CHUNK_SIZE 1024
+#endif
+
+#ifndef RP2040config_DIGEST_MAX_CHUNKS
+#define RP2040config_DIGEST_MAX_CHUNKS 64
+#endif
+
+/*
+Thread local storage pointer of the replicas of create_nmr_function_validator holding their index
+(see nmr_replica_id). The last one is taken by the host build to emulate the cores.
+*/
+#ifndef RP2040config_NMR_TLS_INDEX
+#define RP2040config_NMR_TLS_INDEX 0
+#endif
+
+/*
+If set to 1 the masters report their results as binary records (see LibraryFreeRTOS_RP2040Telemetry.h)
+instead of printing them: each master writes in its own ring of RP2040config_TELEMETRY_RING_SIZE bytes,
+which is sent out by a drain task every RP2040config_TELEMETRY_DRAIN_PERIOD ticks (or as soon as it is
+half full). When the ring is full the master waits, or with RP2040config_TELEMETRY_DROP_WHEN_FULL
+it drops the record and reports how many were lost. On the host the records go to RP2040config_TELEMETRY_PATH.
+*/
+#ifndef RP2040config_USE_TELEMETRY
+#define RP2040config_USE_TELEMETRY 0
+#endif
+
+#ifndef RP2040config_TELEMETRY_RING_SIZE
+#define RP2040config_TELEMETRY_RING_SIZE 1024
+#endif
+
+#ifndef RP2040config_TELEMETRY_MAX_TESTS
+#define RP2040config_TELEMETRY_MAX_TESTS 4
+#endif
+
+#ifndef RP2040config_TELEMETRY_DROP_WHEN_FULL
+#define RP2040config_TELEMETRY_DROP_WHEN_FULL 0
+#endif
+
+#ifndef RP2040config_TELEMETRY_DRAIN_PERIOD
+#define RP2040config_TELEMETRY_DRAIN_PERIOD 1
+#endif
+
+#ifndef RP2040config_TELEMETRY_PATH
+#define RP2040config_TELEMETRY_PATH "telemetry.bin"
+#endif
+
+#define RP2040config_tskTELEMETRY_PRIORITY   tskIDLE_PRIORITY
+#define RP2040config_tskTELEMETRY_STACK_SIZE configMINIMAL_STACK_SIZE
+
+#ifndef RP2040config_PROFILER_PERIOD
+#define RP2040config_PROFILER_PERIOD 1000
+#endif
+
+#ifndef RP2040config_PROFILER_MAX_TASKS
+#define RP2040config_PROFILER_MAX_TASKS 16
+#endif
+
+#ifndef RP2040config_PROFILER_TLS_INDEX
+#define RP2040config_PROFILER_TLS_INDEX 1
+#endif
+
+#define RP2040config_tskPROFILER_PRIORITY   tskIDLE_PRIORITY
+#define RP2040config_tskPROFILER_STACK_SIZE configMINIMAL_STACK_SIZE
+
+/*
+Comparison of the float and double results by DEFAULT_CHECK (see LibraryFreeRTOS_RP2040Compare.h):
+same bits, at most RP2040config_CHECK_MAX_ULP units in the last place apart, or a relative
+difference of at most RP2040config_CHECK_EPSILON. The other types are always compared bitwise.
+*/
+#define RP2040_CHECK_BITWISE        0
+#define RP2040_CHECK_ULP            1
+#define RP2040_CHECK_EPSILON        2
+
+#ifndef RP2040config_CHECK_FLOAT
+#define RP2040config_CHECK_FLOAT RP2040_CHECK_BITWISE
+#endif
+
+#ifndef RP2040config_CHECK_MAX_ULP
+#define RP2040config_CHECK_MAX_ULP 4
+#endif
+
+#ifndef RP2040config_CHECK_EPSILON
+#define RP2040config_CHECK_EPSILON 1e-6
+#endif
+
+/*
+Backend used to measure return_time (see LibraryFreeRTOS_RP2040Timing.h):
+cycles from SysTick, microseconds from the RP2040 timer, or nanoseconds from
+clock_gettime(CLOCK_MONOTONIC_RAW) on the host.
+The cycles are exact only for measurements which stay on one core: the dispatch and vote
+times of masters which are not pinned, and the wall time of the runner, may fall back to the
+resolution of the microsecond timer.
+*/
+#define RP2040_TIMING_SYSTICK       0
+#define RP2040_TIMING_US_TIMER      1
+#define RP2040_TIMING_MONOTONIC_RAW 2
+
+#ifndef RP2040config_TIMING_BACKEND
+#ifdef RP2040_HOST_BUILD
+#define RP2040config_TIMING_BACKEND RP2040_TIMING_MONOTONIC_RAW
+#else
+#define RP2040config_TIMING_BACKEND RP2040_TIMING_SYSTICK
+#endif
+#endif
+
 #endif
\ No newline at end of file
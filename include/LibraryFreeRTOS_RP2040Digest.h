@@ -0,0 +1,187 @@
+/*
+
+Streaming digests of the outputs too large to be returned by value
+(see create_multicore_buffer_validator in LibraryFreeRTOS_RP2040.h).
+
+Every core writes its output into its own buffer through a digest_stream (digest_write,
+digest_put). The buffer is split in chunks of RP2040config_DIGEST_CHUNK_SIZE bytes: a chunk is
+hashed (32-bit xxHash) as soon as it is complete, while it is still in the cache, so the cost of
+the digest is spread over the production of the output and paid by each core in parallel.
+At the end the digest of the output is the hash of the digests of its chunks and of its size.
+
+The master compares only the digests of the cores. When they differ, the digests of the chunks
+give the first chunk which differs, and only that chunk is compared byte by byte (digest_locate).
+
+The bytes written past the capacity of the buffer are counted but dropped, so the sizes still differ.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_DIGEST_H
+#define LIBRARY_FREE_RTOS_RP2040_DIGEST_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DIGEST_AGREE SIZE_MAX
+
+#define DIGEST_PRIME_1 2654435761u
+#define DIGEST_PRIME_2 2246822519u
+#define DIGEST_PRIME_3 3266489917u
+#define DIGEST_PRIME_4 668265263u
+#define DIGEST_PRIME_5 374761393u
+
+struct digest_stream{
+    uint8_t *buffer;
+    size_t capacity;
+    size_t size;            /* Bytes written, even the ones dropped. */
+    uint32_t chunks;        /* Chunks hashed. */
+    uint32_t digest;        /* Valid after digest_finish. */
+    uint32_t chunk_digests[RP2040config_DIGEST_MAX_CHUNKS];
+};
+
+static inline uint32_t digest_rotl(uint32_t value, uint32_t bits){
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t digest_read32(const uint8_t *bytes){
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));   /* Unaligned, little endian on both targets. */
+    return value;
+}
+
+static inline uint32_t digest_round(uint32_t lane, uint32_t input){
+    return digest_rotl(lane + input * DIGEST_PRIME_2, 13) * DIGEST_PRIME_1;
+}
+
+/*
+    32-bit xxHash of size bytes.
+*/
+
+static inline uint32_t digest_hash(const void *data, size_t size, uint32_t seed){
+    const uint8_t *bytes = (const uint8_t *) data;
+    const uint8_t *end = bytes + size;
+    uint32_t hash;
+    if(size >= 16){
+        uint32_t lanes[4] = {seed + DIGEST_PRIME_1 + DIGEST_PRIME_2, seed + DIGEST_PRIME_2, seed, seed - DIGEST_PRIME_1};
+        for(; end - bytes >= 16; bytes += 16){
+            lanes[0] = digest_round(lanes[0], digest_read32(bytes));
+            lanes[1] = digest_round(lanes[1], digest_read32(bytes + 4));
+            lanes[2] = digest_round(lanes[2], digest_read32(bytes + 8));
+            lanes[3] = digest_round(lanes[3], digest_read32(bytes + 12));
+        }
+        hash = digest_rotl(lanes[0], 1) + digest_rotl(lanes[1], 7) + digest_rotl(lanes[2], 12) + digest_rotl(lanes[3], 18);
+    } else {
+        hash = seed + DIGEST_PRIME_5;
+    }
+    hash += (uint32_t) size;
+    for(; end - bytes >= 4; bytes += 4){
+        hash = digest_rotl(hash + digest_read32(bytes) * DIGEST_PRIME_3, 17) * DIGEST_PRIME_4;
+    }
+    for(; bytes < end; ++bytes){
+        hash = digest_rotl(hash + *bytes * DIGEST_PRIME_5, 11) * DIGEST_PRIME_1;
+    }
+    hash ^= hash >> 15;
+    hash *= DIGEST_PRIME_2;
+    hash ^= hash >> 13;
+    hash *= DIGEST_PRIME_3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static inline size_t digest_stored(const struct digest_stream *stream){
+    return stream->size < stream->capacity ? stream->size : stream->capacity;
+}
+
+static inline void digest_init(struct digest_stream *stream, uint8_t *buffer, size_t capacity){
+    stream->buffer = buffer;
+    stream->capacity = capacity;
+    stream->size = 0;
+    stream->chunks = 0;
+    stream->digest = 0;
+}
+
+static inline void digest_reset(struct digest_stream *stream){
+    digest_init(stream, stream->buffer, stream->capacity);
+}
+
+/*
+    Hashes the chunks completed since the last call, and the incomplete last one if final.
+*/
+
+static inline void digest_hash_chunks(struct digest_stream *stream, bool final){
+    size_t stored = digest_stored(stream);
+    while(stream->chunks < RP2040config_DIGEST_MAX_CHUNKS){
+        size_t start = (size_t) stream->chunks * RP2040config_DIGEST_CHUNK_SIZE;
+        size_t length = stored - start;
+        if(start >= stored || (length < RP2040config_DIGEST_CHUNK_SIZE && !final)){
+            break;
+        }
+        if(length > RP2040config_DIGEST_CHUNK_SIZE){
+            length = RP2040config_DIGEST_CHUNK_SIZE;
+        }
+        stream->chunk_digests[stream->chunks++] = digest_hash(stream->buffer + start, length, 0);
+    }
+}
+
+static inline void digest_write(struct digest_stream *stream, const void *data, size_t size){
+    size_t stored = digest_stored(stream);
+    size_t copied = stream->capacity - stored < size ? stream->capacity - stored : size;
+    memcpy(stream->buffer + stored, data, copied);
+    stream->size += size;
+    if(copied > 0 && stored / RP2040config_DIGEST_CHUNK_SIZE != (stored + copied) / RP2040config_DIGEST_CHUNK_SIZE){
+        digest_hash_chunks(stream, false);
+    }
+}
+
+/*
+    Writes value (any lvalue) to the stream.
+*/
+#define digest_put(stream, value) digest_write((stream), &(value), sizeof(value))
+
+static inline uint32_t digest_finish(struct digest_stream *stream){
+    digest_hash_chunks(stream, true);
+    stream->digest = digest_hash(stream->chunk_digests, stream->chunks * sizeof(stream->chunk_digests[0]),
+        (uint32_t) stream->size);
+    return stream->digest;
+}
+
+/*
+    Offset of the first byte where the outputs of two streams differ, or DIGEST_AGREE if they are the same.
+    Only the first chunk whose digests differ is compared byte by byte; if no chunk differs,
+    the outputs differ in their size (or in the bytes dropped), from the end of the shortest one.
+*/
+
+static inline size_t digest_locate(const struct digest_stream *a, const struct digest_stream *b){
+    if(a->digest == b->digest && a->size == b->size){
+        return DIGEST_AGREE;
+    }
+    uint32_t chunks = a->chunks < b->chunks ? a->chunks : b->chunks;
+    for(uint32_t c=0; c<chunks; ++c){
+        if(a->chunk_digests[c] != b->chunk_digests[c]){
+            size_t start = (size_t) c * RP2040config_DIGEST_CHUNK_SIZE;
+            size_t end = start + RP2040config_DIGEST_CHUNK_SIZE;
+            size_t stored_a = digest_stored(a), stored_b = digest_stored(b);
+            end = end < stored_a ? end : stored_a;
+            end = end < stored_b ? end : stored_b;
+            for(size_t i=start; i<end; ++i){
+                if(a->buffer[i] != b->buffer[i]){
+                    return i;
+                }
+            }
+            return end;
+        }
+    }
+    return a->size < b->size ? a->size : b->size;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+
+Traces of checkpoints used by the dual modular redundancy (lockstep) validator
+(see create_multicore_dmr_validator in LibraryFreeRTOS_RP2040.h).
+
+While running a segment of the computation every core appends checkpoints (hashes of its
+intermediate values) to its own trace; the master compares the traces of the cores checkpoint
+by checkpoint, so a mismatch is located at the first checkpoint where the cores diverged,
+not only at the end of the computation.
+
+A trace is written by one core only, and read by the master after the segment has completed.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_DMR_H
+#define LIBRARY_FREE_RTOS_RP2040_DMR_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define DMR_AGREE UINT32_MAX
+
+struct dmr_trace{
+    uint32_t count;         /* Checkpoints emitted in the segment, even the ones not stored. */
+    uint32_t checkpoints[RP2040config_DMR_TRACE_SIZE];
+};
+
+/*
+    32-bit FNV-1a hash of size bytes.
+*/
+
+static inline uint32_t dmr_hash(const void *data, size_t size){
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint32_t hash = 2166136261u;
+    for(size_t i=0; i<size; ++i){
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline void dmr_trace_reset(struct dmr_trace *trace){
+    trace->count = 0;
+}
+
+static inline void dmr_trace_add(struct dmr_trace *trace, uint32_t checkpoint){
+    if(trace->count < RP2040config_DMR_TRACE_SIZE){
+        trace->checkpoints[trace->count] = checkpoint;
+    }
+    trace->count++;
+}
+
+/*
+    Index of the first checkpoint where the traces of the cores differ,
+    or DMR_AGREE if they are the same.
+    Past RP2040config_DMR_TRACE_SIZE only the number of checkpoints is compared.
+*/
+
+static inline uint32_t dmr_trace_compare(const struct dmr_trace *traces){
+    uint32_t count = traces[0].count;
+    for(int i=1; i<RP2040config_testRUN_ON_CORES; ++i){
+        if(traces[i].count < count){
+            count = traces[i].count;
+        }
+    }
+    uint32_t stored = count < RP2040config_DMR_TRACE_SIZE ? count : RP2040config_DMR_TRACE_SIZE;
+    for(uint32_t c=0; c<stored; ++c){
+        for(int i=1; i<RP2040config_testRUN_ON_CORES; ++i){
+            if(traces[i].checkpoints[c] != traces[0].checkpoints[c]){
+                return c;
+            }
+        }
+    }
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        if(traces[i].count != count){
+            return count;   /* One core emitted more checkpoints. */
+        }
+    }
+    return DMR_AGREE;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+
+Fault injection for the validators, used to measure how well a check_function detects faults.
+
+With RP2040config_USE_FAULT_INJECTION the master decides, before every attempt, whether to inject
+a fault, with the probability of the test in parts per million (RP2040config_FAULT_RATE_PPM unless
+changed with configure_faults), drawing from a seeded PRNG so that a run can be reproduced. The fault hits one random core and is one of the kinds
+enabled in RP2040config_FAULT_KINDS:
+
+- FAULT_FLIP_RESULT     : one random bit of the result of the core is flipped by the slave,
+                          before it publishes the result to the master.
+- FAULT_CORRUPT_INPUT   : one random bit of the input copied for the core by prepare_input_for_slaves
+                          is flipped (task validator only).
+- FAULT_DELAY_CORE      : the core busy-waits RP2040config_FAULT_DELAY_US before running the function.
+                          This must not change the result: a mismatch is a false positive.
+
+After the check every attempt falls in one of:
+
+- detected          : a value fault was injected and the check failed.
+- missed            : a value fault was injected and the check passed.
+- false positive    : no value fault was injected and the check failed.
+
+The detection latency is the time from the injection to the failed check: for a flipped result,
+from the end of the computation of the slave to the check of the master, so it includes the
+wake-up of the master. The injection and the check usually run on different cores: with the
+SysTick backend the latency has the resolution of the microsecond timer (see
+LibraryFreeRTOS_RP2040Timing.h). A delay is not a value fault and has no latency.
+
+Every test has its own plan and PRNG, drawn and updated by its master only; the slaves just
+read the fault planned for them and stamp the time of the injection, which the master reads
+after the slaves have completed, so the injection does not need any lock.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_FAULT_H
+#define LIBRARY_FREE_RTOS_RP2040_FAULT_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "LibraryFreeRTOS_RP2040Timing.h"
+#include "hardware/timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define FAULT_NONE              0u
+#define FAULT_FLIP_RESULT       (1u << 0)
+#define FAULT_CORRUPT_INPUT     (1u << 1)
+#define FAULT_DELAY_CORE        (1u << 2)
+
+#define FAULT_VALUE_KINDS       (FAULT_FLIP_RESULT | FAULT_CORRUPT_INPUT)
+
+struct fault_plan{
+    uint64_t prng;          /* State of the PRNG of the test. */
+    uint32_t rate_ppm;      /* Probability of a fault in an attempt, in parts per million. */
+    uint32_t kind;          /* FAULT_NONE if nothing is injected in this attempt. */
+    uint32_t core;
+    uint32_t bit;           /* Random bit, reduced modulo the size of the target. */
+    timing_stamp_t injected_at;
+};
+
+struct fault_stats{
+    uint32_t checks;
+    uint32_t injected;      /* Value faults only. */
+    uint32_t delays;
+    uint32_t detected;
+    uint32_t missed;
+    uint32_t false_positives;
+    uint64_t latency_total;
+};
+
+#define FAULT_PLAN_INIT { RP2040config_FAULT_SEED, RP2040config_FAULT_RATE_PPM, FAULT_NONE, 0, 0 }
+
+/*
+    xorshift64* generator.
+*/
+
+static inline uint32_t fault_random(struct fault_plan *plan){
+    plan->prng ^= plan->prng >> 12;
+    plan->prng ^= plan->prng << 25;
+    plan->prng ^= plan->prng >> 27;
+    return (uint32_t) ((plan->prng * 2685821657736338717ull) >> 32);
+}
+
+static inline void fault_seed(struct fault_plan *plan, uint64_t seed){
+    plan->prng = seed != 0 ? seed : 1;
+}
+
+/*
+    Draws the fault of the next attempt among the kinds given.
+*/
+
+static inline void fault_plan_next(struct fault_plan *plan, uint32_t kinds){
+    plan->kind = FAULT_NONE;
+    if(kinds == 0 || fault_random(plan) % 1000000u >= plan->rate_ppm){
+        return;
+    }
+    uint32_t enabled[3], count = 0;
+    for(uint32_t kind=FAULT_FLIP_RESULT; kind<=FAULT_DELAY_CORE; kind<<=1){
+        if(kinds & kind){
+            enabled[count++] = kind;
+        }
+    }
+    plan->core = fault_random(plan) % RP2040config_testRUN_ON_CORES;
+    plan->bit = fault_random(plan);
+    __atomic_store_n(&plan->kind, enabled[fault_random(plan) % count], __ATOMIC_RELEASE);
+}
+
+/*
+    Flips the planned bit of data if the plan is of the given kind and targets core.
+*/
+
+static inline void fault_flip(struct fault_plan *plan, uint32_t kind, uint32_t core, void *data, size_t size){
+    if(plan->kind == kind && plan->core == core && size > 0){
+        uint32_t bit = plan->bit % (uint32_t) (size*8);
+        ((uint8_t *) data)[bit/8] ^= (uint8_t) (1u << (bit%8));
+        plan->injected_at = timing_now();
+    }
+}
+
+static inline void fault_delay(const struct fault_plan *plan, uint32_t core){
+    if(__atomic_load_n(&plan->kind, __ATOMIC_ACQUIRE) == FAULT_DELAY_CORE && plan->core == core){
+        busy_wait_us(RP2040config_FAULT_DELAY_US);
+    }
+}
+
+/*
+    Classifies the attempt just checked, then clears the plan.
+*/
+
+static inline void fault_record(struct fault_stats *stats, struct fault_plan *plan, bool check_result){
+    bool injected = (plan->kind & FAULT_VALUE_KINDS) != 0;
+    stats->checks++;
+    stats->delays += plan->kind == FAULT_DELAY_CORE;
+    if(injected){
+        stats->injected++;
+        if(check_result){
+            stats->missed++;
+        } else {
+            stats->detected++;
+            stats->latency_total += timing_elapsed(plan->injected_at);
+        }
+    } else if(!check_result){
+        stats->false_positives++;
+    }
+    plan->kind = FAULT_NONE;
+}
+
+static inline void fault_stats_print(const char *test_name, const struct fault_stats *stats){
+    uint32_t clean = stats->checks - stats->injected;
+    printf("%s> fault_injected:\t %lu \n", test_name, (unsigned long) stats->injected);
+    printf("%s> fault_delays:\t %lu \n", test_name, (unsigned long) stats->delays);
+    printf("%s> fault_detected:\t %lu \n", test_name, (unsigned long) stats->detected);
+    printf("%s> fault_missed:\t %lu \n", test_name, (unsigned long) stats->missed);
+    printf("%s> detection_rate:\t %lu.%02lu %% \n", test_name,
+        (unsigned long) (stats->injected ? 100ull*stats->detected/stats->injected : 0),
+        (unsigned long) (stats->injected ? 10000ull*stats->detected/stats->injected % 100 : 0));
+    printf("%s> false_positive_rate:\t %lu.%02lu %% \n", test_name,
+        (unsigned long) (clean ? 100ull*stats->false_positives/clean : 0),
+        (unsigned long) (clean ? 10000ull*stats->false_positives/clean % 100 : 0));
+    printf("%s> detection_latency_avg:\t %llu " RP2040_TIME_UNIT "\n", test_name,
+        (unsigned long long) (stats->detected ? stats->latency_total/stats->detected : 0));
+}
+
+#endif
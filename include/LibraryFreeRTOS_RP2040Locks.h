@@ -0,0 +1,125 @@
+/*
+
+Lock primitives which need no atomic read-modify-write instruction.
+
+The Cortex-M0+ of the RP2040 has no LDREX/STREX, so a lock is either built on the hardware
+spin locks of the SIO (see hardware/sync.h) or, as the ones below, only on aligned 32-bit
+loads/stores ordered by memory barriers:
+
+- peterson_lock     : Peterson's algorithm, for two cores.
+- ticket_lock       : FIFO lock; as fetch-and-increment is not available, every core takes its ticket
+                      as one more than the largest ticket it sees (Lamport's bakery algorithm).
+
+A counter needs no lock at all when every core has its own slot (see LibraryFreeRTOS_RP2040Sharded.h).
+
+While waiting they call LOCK_SPIN_WAIT(): on a single core port (the host) the holder must be
+allowed to run, so the waiting task yields.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_LOCKS_H
+#define LIBRARY_FREE_RTOS_RP2040_LOCKS_H
+
+#include "FreeRTOS.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "task.h"
+#include "pico/platform.h"
+#include <stdint.h>
+
+#if configNUMBER_OF_CORES == 1
+#define LOCK_SPIN_WAIT() taskYIELD()
+#else
+#define LOCK_SPIN_WAIT() tight_loop_contents()
+#endif
+
+// ------------------------------------------------------------------------ //
+//  PETERSON                                                                //
+// ------------------------------------------------------------------------ //
+
+struct peterson_lock{
+    uint32_t interested[2];
+    uint32_t turn;
+};
+
+static inline void peterson_init(struct peterson_lock *lock){
+    lock->interested[0] = 0;
+    lock->interested[1] = 0;
+    lock->turn = 0;
+}
+
+/*
+    me is the core of the caller (0 or 1). The stores must not be reordered with
+    the following loads, hence the sequentially consistent accesses (DMB on the M0+).
+*/
+
+static inline void peterson_lock(struct peterson_lock *lock, uint32_t me){
+    uint32_t other = 1 - me;
+    __atomic_store_n(&lock->interested[me], 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&lock->turn, other, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&lock->interested[other], __ATOMIC_SEQ_CST) &&
+          __atomic_load_n(&lock->turn, __ATOMIC_SEQ_CST) == other){
+        LOCK_SPIN_WAIT();
+    }
+}
+
+static inline void peterson_unlock(struct peterson_lock *lock, uint32_t me){
+    __atomic_store_n(&lock->interested[me], 0, __ATOMIC_RELEASE);
+}
+
+// ------------------------------------------------------------------------ //
+//  TICKET (BAKERY)                                                         //
+// ------------------------------------------------------------------------ //
+
+struct ticket_lock{
+    uint32_t choosing[RP2040config_testRUN_ON_CORES];
+    uint32_t ticket[RP2040config_testRUN_ON_CORES];     /* 0 if the core does not want the lock. */
+};
+
+static inline void ticket_init(struct ticket_lock *lock){
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        lock->choosing[i] = 0;
+        lock->ticket[i] = 0;
+    }
+}
+
+static inline void ticket_lock(struct ticket_lock *lock, uint32_t me){
+    uint32_t ticket = 0;
+    __atomic_store_n(&lock->choosing[me], 1, __ATOMIC_SEQ_CST);
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        uint32_t other = __atomic_load_n(&lock->ticket[i], __ATOMIC_SEQ_CST);
+        if(other > ticket){
+            ticket = other;
+        }
+    }
+    ticket++;
+    __atomic_store_n(&lock->ticket[me], ticket, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&lock->choosing[me], 0, __ATOMIC_SEQ_CST);
+    for(uint32_t i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        if(i == me){
+            continue;
+        }
+        while(__atomic_load_n(&lock->choosing[i], __ATOMIC_SEQ_CST)){
+            LOCK_SPIN_WAIT();
+        }
+        while(true){
+            uint32_t other = __atomic_load_n(&lock->ticket[i], __ATOMIC_SEQ_CST);
+            /* Served in ticket order, ties broken by core number. */
+            if(other == 0 || other > ticket || (other == ticket && i > me)){
+                break;
+            }
+            LOCK_SPIN_WAIT();
+        }
+    }
+}
+
+static inline void ticket_unlock(struct ticket_lock *lock, uint32_t me){
+    __atomic_store_n(&lock->ticket[me], 0, __ATOMIC_RELEASE);
+}
+
+#endif
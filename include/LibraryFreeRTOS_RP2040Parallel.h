@@ -0,0 +1,230 @@
+/*
+
+Work-stealing parallel_for/parallel_reduce over the cores.
+
+Unlike the validators, which run the same function on every core and compare the results,
+these split one range of indices between the cores. They reuse the worker pool of the
+validators: one worker pinned to each core, woken by a task notification.
+
+The range [begin, end) is cut in chunks of chunk_size indices, and every core gets a deque
+holding an equal share of them. A deque is just a range of chunk numbers: its owner takes chunks
+from the front, and when it is empty it steals half of the chunks left at the back of the
+deque of another core, so that uneven chunks still keep all the cores busy.
+
+The M0+ has no compare-and-swap, so every deque is protected by one of the hardware spin locks
+of the SIO (held for a few instructions only).
+
+    static struct parallel_pool pool;
+
+    parallel_pool_start(&pool);         // From the task calling parallel_for.
+    parallel_for(&pool, 0, N, 64, body, ctx);
+    parallel_pool_stop(&pool);
+
+body(ctx, chunk_begin, chunk_end) is called once per chunk, from any core.
+The reductions are declared with create_parallel_reduce.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_PARALLEL_H
+#define LIBRARY_FREE_RTOS_RP2040_PARALLEL_H
+
+#include "LibraryFreeRTOS_RP2040.h"
+#include "hardware/sync.h"
+
+typedef void (*parallel_body_t)(void *ctx, uint32_t begin, uint32_t end);
+
+struct parallel_deque{
+    spin_lock_t *lock;
+    uint32_t head;          /* First chunk left, taken by the owner. */
+    uint32_t tail;          /* One past the last chunk left, stolen by the other cores. */
+};
+
+struct parallel_pool;
+
+struct parallel_worker{
+    struct parallel_pool *pool;
+    uint32_t core;
+    uint32_t chunks;        /* Chunks run by this core in the last parallel_for. */
+    uint32_t steals;        /* Successful steals of this core in the last parallel_for. */
+};
+
+struct parallel_pool{
+    struct worker_pool workers;
+    struct parallel_worker params[RP2040config_testRUN_ON_CORES];
+    struct parallel_deque deques[RP2040config_testRUN_ON_CORES];
+    /* Job of the current parallel_for. */
+    parallel_body_t body;
+    void *ctx;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t chunk_size;
+#if RP2040config_USE_STATIC_ALLOCATION
+    struct{
+        StackType_t stacks[RP2040config_testRUN_ON_CORES][RP2040config_tskSLAVE_STACK_SIZE];
+        StaticTask_t tcbs[RP2040config_testRUN_ON_CORES];
+    } storage;
+#endif
+};
+
+/*
+    Takes the first chunk of the deque of the calling core.
+*/
+
+static inline bool parallel_pop(struct parallel_deque *deque, uint32_t *chunk){
+    bool found = false;
+    uint32_t saved = spin_lock_blocking(deque->lock);
+    if(deque->head < deque->tail){
+        *chunk = deque->head++;
+        found = true;
+    }
+    spin_unlock(deque->lock, saved);
+    return found;
+}
+
+/*
+    Moves the back half of the chunks of victim to thief (which is empty).
+*/
+
+static inline bool parallel_steal(struct parallel_deque *victim, struct parallel_deque *thief){
+    uint32_t first = 0, last = 0;
+    uint32_t saved = spin_lock_blocking(victim->lock);
+    if(victim->head < victim->tail){
+        last = victim->tail;
+        first = last - (last - victim->head + 1)/2;
+        victim->tail = first;
+    }
+    spin_unlock(victim->lock, saved);
+    if(first == last){
+        return false;
+    }
+    saved = spin_lock_blocking(thief->lock);
+    thief->head = first;
+    thief->tail = last;
+    spin_unlock(thief->lock, saved);
+    return true;
+}
+
+/*
+    Job of the workers: runs the chunks of its own deque, then steals from the others.
+    It returns when every deque has been found empty.
+*/
+
+static void parallel_worker_job(void *param){
+    struct parallel_worker *worker = (struct parallel_worker *) param;
+    struct parallel_pool *pool = worker->pool;
+    struct parallel_deque *own = &pool->deques[worker->core];
+    uint32_t chunk;
+
+    worker->chunks = 0;
+    worker->steals = 0;
+    while(true){
+        while(parallel_pop(own, &chunk)){
+            uint32_t first = pool->begin + chunk*pool->chunk_size;
+            uint32_t last = pool->end - first > pool->chunk_size ? first + pool->chunk_size : pool->end;
+            pool->body(pool->ctx, first, last);
+            worker->chunks++;
+        }
+        bool stolen = false;
+        for(uint32_t i=1; i<RP2040config_testRUN_ON_CORES && !stolen; ++i){
+            stolen = parallel_steal(&pool->deques[(worker->core + i) % RP2040config_testRUN_ON_CORES], own);
+        }
+        if(!stolen){
+            break;
+        }
+        worker->steals++;
+    }
+}
+
+/*
+    Creates the workers and claims the spin locks of the deques.
+    The calling task is the only one allowed to call parallel_for on the pool.
+*/
+
+static inline void parallel_pool_start(struct parallel_pool *pool){
+    for(uint32_t i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        pool->params[i].pool = pool;
+        pool->params[i].core = i;
+        pool->deques[i].lock = spin_lock_instance(spin_lock_claim_unused(true));
+        pool->deques[i].head = 0;
+        pool->deques[i].tail = 0;
+    }
+#if RP2040config_USE_STATIC_ALLOCATION
+    worker_pool_storage(&pool->workers, RP2040config_tskSLAVE_STACK_SIZE, TASK_STORAGE_ALL(pool->storage));
+#endif
+    worker_pool_start(&pool->workers, "vParallelWorker", parallel_worker_job, pool->params, sizeof(pool->params[0]));
+}
+
+/*
+    Calls body on all the chunks of [begin, end), split between the cores,
+    and returns when all of them have been run.
+*/
+
+static inline void parallel_for(struct parallel_pool *pool, uint32_t begin, uint32_t end, uint32_t chunk_size, parallel_body_t body, void *ctx){
+    configASSERT(chunk_size > 0);
+    uint32_t chunks = end > begin ? (end - begin + chunk_size - 1)/chunk_size : 0;
+    pool->body = body;
+    pool->ctx = ctx;
+    pool->begin = begin;
+    pool->end = end;
+    pool->chunk_size = chunk_size;
+    for(uint32_t i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        pool->deques[i].head = chunks*i/RP2040config_testRUN_ON_CORES;
+        pool->deques[i].tail = chunks*(i+1)/RP2040config_testRUN_ON_CORES;
+    }
+    __dmb();    /* The workers must see the job before being woken up. */
+    worker_pool_dispatch(&pool->workers);
+    worker_pool_wait(&pool->workers);
+}
+
+/*
+    Stops the workers and gives back the spin locks of the deques.
+*/
+
+static inline void parallel_pool_stop(struct parallel_pool *pool){
+    worker_pool_stop(&pool->workers);
+    for(uint32_t i=0; i<RP2040config_testRUN_ON_CORES; ++i){
+        spin_lock_unclaim(spin_lock_get_num(pool->deques[i].lock));
+    }
+}
+
+/*
+    Declares the function
+
+        type name(struct parallel_pool *pool, uint32_t begin, uint32_t end, uint32_t chunk_size,
+                  type (*body)(void *ctx, uint32_t begin, uint32_t end), void *ctx);
+
+    which returns the combination of the values returned by body for all the chunks.
+    Every core combines its chunks in its own slot of a sharded accumulator, then the slots
+    are combined in core order: combine(a, b) must be associative and commutative,
+    and identity its neutral element.
+*/
+#define create_parallel_reduce(name, type, identity, combine)                                        \
+create_sharded_accumulator(name##_partials, type)                                                    \
+static type (*name##_body)(void *ctx, uint32_t begin, uint32_t end);                                 \
+                                                                                                     \
+static void name##_chunk(void *ctx, uint32_t begin, uint32_t end){                                   \
+    type value = name##_body(ctx, begin, end);                                                       \
+    sharded_slot(name##_partials) = combine(sharded_slot(name##_partials), value);                   \
+}                                                                                                    \
+                                                                                                     \
+static type name(struct parallel_pool *pool, uint32_t begin, uint32_t end, uint32_t chunk_size,      \
+                 type (*body)(void *ctx, uint32_t begin, uint32_t end), void *ctx){                  \
+    type result = identity;                                                                          \
+    name##_body = body;                                                                              \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+        name##_partials[i].value = identity;                                                         \
+    }                                                                                                \
+    parallel_for(pool, begin, end, chunk_size, name##_chunk, ctx);                                   \
+    for(int i=0; i<RP2040config_testRUN_ON_CORES; ++i){                                              \
+        result = combine(result, name##_partials[i].value);                                          \
+    }                                                                                                \
+    return result;                                                                                   \
+}                                                                                                    \
+
+#endif
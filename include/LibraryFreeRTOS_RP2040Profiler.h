@@ -0,0 +1,304 @@
+/*
+
+Profiler of the scheduler, enabled with RP2040config_USE_PROFILER.
+
+The trace macros of the kernel (LibraryFreeRTOS_RP2040Trace.h) call the hooks below on every
+task creation, deletion, context switch, and notification. The hooks run inside the kernel
+(in its critical sections, or in the context switch), so they never block nor print: they only
+read a counter (the microsecond timer on the RP2040, CLOCK_MONOTONIC_RAW on the host) and
+update the counters of the task and of the core. Every RP2040config_PROFILER_PERIOD ticks a task
+of the lowest priority copies and resets the counters, in a short critical section, and prints:
+
+    profiler> period:\t 1000012 us
+    profiler> core_0:\t idle 71.3 %, switches 1204
+    profiler> task_vTaskMaster:\t run 21034 us (2.1 %), wakes 200, latency avg 18 max 42 us
+
+- idle          : time of the core not spent running tasks other than the idle tasks.
+- switches      : times a different task was switched in on the core.
+- run           : time the task ran in the period.
+- wakes/latency : times the task was woken by a notification it was blocked on, and the time
+                  from the notification to the task running again.
+
+The tasks are followed through their thread local storage pointer RP2040config_PROFILER_TLS_INDEX,
+at most RP2040config_PROFILER_MAX_TASKS at a time (the slot of a deleted task is reused once it
+has been reported); the others are counted as untracked.
+
+On the host the cores are the emulated ones (see host/include/pico/platform.h): the time of a
+task goes to its logical core, and the idle time of a core is the time left by its tasks.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_PROFILER_H
+#define LIBRARY_FREE_RTOS_RP2040_PROFILER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "pico/platform.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef RP2040_HOST_BUILD
+#include <time.h>
+#else
+#include "hardware/timer.h"
+#endif
+
+#if RP2040config_PROFILER_TLS_INDEX == RP2040config_NMR_TLS_INDEX
+#error "RP2040config_PROFILER_TLS_INDEX is used by the NMR validator"
+#endif
+
+#define PROFILER_CORES 2    /* Of the RP2040, emulated on the host. */
+
+#ifdef RP2040_HOST_BUILD
+
+#define PROFILER_TIME_UNIT "ns"
+
+static inline uint64_t profiler_now(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+#else
+
+#define PROFILER_TIME_UNIT "us"
+
+static inline uint64_t profiler_now(){
+    return time_us_64();
+}
+
+#endif
+
+struct profiler_task{
+    char name[configMAX_TASK_NAME_LEN];
+    bool used;              /* The slot holds a task. */
+    bool deleted;           /* The slot is freed once the task is reported and no longer running. */
+    bool idle;              /* Idle task: its time is idle time of the core. */
+    bool running;
+    bool waiting;           /* Blocked waiting for a notification. */
+    bool notified;          /* Notified while waiting, not running yet. */
+    uint8_t core;           /* Core it is (was last) running on. */
+    uint64_t switched_in;
+    uint64_t notified_at;
+    uint64_t runtime;
+    uint32_t wakes;
+    uint64_t latency_total;
+    uint64_t latency_max;
+};
+
+struct profiler_core{
+    uint64_t busy;          /* Time spent running tasks other than the idle ones. */
+    uint32_t switches;
+    uint32_t last;          /* Slot + 1 of the last task switched in, 0 if not followed. */
+};
+
+static struct profiler_task profiler_tasks[RP2040config_PROFILER_MAX_TASKS];
+static struct profiler_core profiler_cores[PROFILER_CORES];
+static uint32_t profiler_untracked = 0;
+
+static TaskHandle_t profilerHandle = NULL;
+#if RP2040config_USE_STATIC_ALLOCATION
+static StackType_t profilerStack[RP2040config_tskPROFILER_STACK_SIZE];
+static StaticTask_t profilerTcb;
+#endif
+
+static inline struct profiler_task *profiler_slot(TaskHandle_t task){
+    uint32_t id = (uint32_t) (uintptr_t) pvTaskGetThreadLocalStoragePointer(task, RP2040config_PROFILER_TLS_INDEX);
+    return id == 0 ? NULL : &profiler_tasks[id-1];
+}
+
+/*
+    Charges the time the task has been running until now to the task and to its core.
+*/
+
+static inline void profiler_charge(struct profiler_task *task, uint64_t now){
+    uint64_t ran = now - task->switched_in;
+    task->runtime += ran;
+    if(!task->idle){
+        profiler_cores[task->core].busy += ran;
+    }
+    task->switched_in = now;
+}
+
+/*
+    Hooks called by the kernel (see LibraryFreeRTOS_RP2040Trace.h).
+*/
+
+void profiler_trace_create(void *task){
+    for(uint32_t i=0; i<RP2040config_PROFILER_MAX_TASKS; ++i){
+        struct profiler_task *slot = &profiler_tasks[i];
+        if(!slot->used){
+            memset(slot, 0, sizeof(*slot));
+            slot->used = true;
+            strncpy(slot->name, pcTaskGetName((TaskHandle_t) task), sizeof(slot->name) - 1);
+            slot->idle = strncmp(slot->name, configIDLE_TASK_NAME, strlen(configIDLE_TASK_NAME)) == 0;
+            vTaskSetThreadLocalStoragePointer((TaskHandle_t) task, RP2040config_PROFILER_TLS_INDEX, (void *) (uintptr_t) (i+1));
+            return;
+        }
+    }
+    profiler_untracked++;
+}
+
+void profiler_trace_delete(void *task){
+    struct profiler_task *slot = profiler_slot((TaskHandle_t) task);
+    if(slot != NULL){
+        slot->deleted = true;
+    }
+}
+
+void profiler_trace_switched_out(void){
+    struct profiler_task *slot = profiler_slot(NULL);
+    if(slot != NULL && slot->running){
+        profiler_charge(slot, profiler_now());
+        slot->running = false;
+    }
+}
+
+void profiler_trace_switched_in(void){
+    uint32_t core = get_core_num();
+    uint32_t id = (uint32_t) (uintptr_t) pvTaskGetThreadLocalStoragePointer(NULL, RP2040config_PROFILER_TLS_INDEX);
+    if(profiler_cores[core].last != id){
+        profiler_cores[core].switches++;
+        profiler_cores[core].last = id;
+    }
+    if(id == 0){
+        return;
+    }
+    struct profiler_task *slot = &profiler_tasks[id-1];
+    uint64_t now = profiler_now();
+    slot->core = (uint8_t) core;
+    slot->switched_in = now;
+    slot->running = true;
+    if(slot->waiting && slot->notified){
+        uint64_t latency = now - slot->notified_at;
+        slot->wakes++;
+        slot->latency_total += latency;
+        if(latency > slot->latency_max){
+            slot->latency_max = latency;
+        }
+    }
+    slot->waiting = false;      /* Woken, by a notification or by the timeout. */
+    slot->notified = false;
+}
+
+void profiler_trace_block(void){
+    struct profiler_task *slot = profiler_slot(NULL);
+    if(slot != NULL){
+        slot->waiting = true;
+    }
+}
+
+void profiler_trace_notify(void *task){
+    struct profiler_task *slot = profiler_slot((TaskHandle_t) task);
+    if(slot != NULL && slot->waiting && !slot->notified){
+        slot->notified = true;
+        slot->notified_at = profiler_now();
+    }
+}
+
+/*
+    Tenths of a percent of part in total.
+*/
+
+static inline uint32_t profiler_permille(uint64_t part, uint64_t total){
+    if(total == 0){
+        return 0;
+    }
+    return part >= total ? 1000 : (uint32_t) (part * 1000 / total);
+}
+
+static void vProfilerFunction(void *pvParameters){
+    static struct profiler_task tasks[RP2040config_PROFILER_MAX_TASKS];
+    struct profiler_core cores[PROFILER_CORES];
+    uint32_t untracked;
+    uint64_t period_start = profiler_now();
+    (void) pvParameters;
+
+    while(true){
+        vTaskDelay(RP2040config_PROFILER_PERIOD);
+
+        taskENTER_CRITICAL();
+        uint64_t now = profiler_now();
+        for(uint32_t i=0; i<RP2040config_PROFILER_MAX_TASKS; ++i){
+            struct profiler_task *task = &profiler_tasks[i];
+            if(task->used && task->running){
+                profiler_charge(task, now);
+            }
+        }
+        memcpy(tasks, profiler_tasks, sizeof(tasks));
+        memcpy(cores, profiler_cores, sizeof(cores));
+        untracked = profiler_untracked;
+        for(uint32_t i=0; i<RP2040config_PROFILER_MAX_TASKS; ++i){
+            struct profiler_task *task = &profiler_tasks[i];
+            task->runtime = 0;
+            task->wakes = 0;
+            task->latency_total = 0;
+            task->latency_max = 0;
+            if(task->deleted && !task->running){
+                task->used = false;
+            }
+        }
+        for(uint32_t core=0; core<PROFILER_CORES; ++core){
+            profiler_cores[core].busy = 0;
+            profiler_cores[core].switches = 0;
+        }
+        taskEXIT_CRITICAL();
+
+        uint64_t period = now - period_start;
+        period_start = now;
+        printf("profiler> period:\t %llu " PROFILER_TIME_UNIT "\n", (unsigned long long) period);
+        for(uint32_t core=0; core<PROFILER_CORES; ++core){
+            uint32_t idle = 1000 - profiler_permille(cores[core].busy, period);
+            printf("profiler> core_%lu:\t idle %lu.%lu %%, switches %lu\n", (unsigned long) core,
+                (unsigned long) idle/10, (unsigned long) idle%10, (unsigned long) cores[core].switches);
+        }
+        for(uint32_t i=0; i<RP2040config_PROFILER_MAX_TASKS; ++i){
+            const struct profiler_task *task = &tasks[i];
+            if(!task->used || (task->runtime == 0 && task->wakes == 0)){
+                continue;
+            }
+            uint32_t share = profiler_permille(task->runtime, period);
+            printf("profiler> task_%s:\t run %llu " PROFILER_TIME_UNIT " (%lu.%lu %%), wakes %lu, latency avg %llu max %llu "
+                PROFILER_TIME_UNIT "\n", task->name, (unsigned long long) task->runtime,
+                (unsigned long) share/10, (unsigned long) share%10, (unsigned long) task->wakes,
+                (unsigned long long) (task->wakes == 0 ? 0 : task->latency_total / task->wakes),
+                (unsigned long long) task->latency_max);
+        }
+        if(untracked != 0){
+            printf("profiler> untracked:\t %lu \n", (unsigned long) untracked);
+        }
+    }
+}
+
+/*
+    Creates the task printing the profile. It is called by start_FreeRTOS.
+*/
+
+static inline void profiler_start(){
+#if RP2040config_USE_STATIC_ALLOCATION
+    profilerHandle = xTaskCreateStatic(vProfilerFunction,
+        "vProfilerFunction",
+        RP2040config_tskPROFILER_STACK_SIZE,
+        NULL,
+        RP2040config_tskPROFILER_PRIORITY,
+        profilerStack,
+        &profilerTcb);
+#else
+    xTaskCreate(vProfilerFunction,
+        "vProfilerFunction",
+        RP2040config_tskPROFILER_STACK_SIZE,
+        NULL,
+        RP2040config_tskPROFILER_PRIORITY,
+        &profilerHandle);
+#endif
+}
+
+#endif
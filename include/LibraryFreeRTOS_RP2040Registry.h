@@ -0,0 +1,254 @@
+/*
+
+Registry of the tests created by the validators, and runner executing them.
+
+Every validator places a descriptor of its test (name, function starting its master, state)
+in the rp2040_tests section, so the linker gathers all the tests of the executable between
+__start_rp2040_tests and __stop_rp2040_tests without any registration call.
+
+start_test_runner(mode, filter) creates the runner task, which starts the selected tests:
+
+- TEST_RUN_SEQUENTIAL   : one at a time, in the order of the section.
+- TEST_RUN_PARALLEL     : all together, as calling start_master for each of them.
+- TEST_RUN_GROUPS       : the tests of a group together, the groups one at a time by increasing
+                          number (configure_test_group, group 0 by default).
+
+A test is finished when its master has joined its slaves, and the runner waits one tick before
+the next test so that the idle task reclaims the deleted tasks: the tests run one after the other
+never share the cores. For every test the runner prints the wall time, from the start of the
+master to its end.
+
+A task checking the results of the tests (a verifier) calls wait_test_runner(), which blocks it
+until the runner has run all the selected tests.
+
+The filter is a comma separated list of test names, a name ending with * matches every test
+starting with it; NULL or "" selects all the tests. On the host the RP2040_TEST_FILTER
+environment variable, if set, replaces the filter given.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_REGISTRY_H
+#define LIBRARY_FREE_RTOS_RP2040_REGISTRY_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "LibraryFreeRTOS_RP2040Timing.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RUN_SEQUENTIAL     0
+#define TEST_RUN_PARALLEL       1
+#define TEST_RUN_GROUPS         2
+
+struct test_state{
+    uint32_t group;
+    timing_stamp_t started;
+    timing_stamp_t finished;
+    volatile bool running;
+};
+
+struct test_descriptor{
+    const char *name;
+    void (*start)(void);
+    struct test_state *state;
+};
+
+/* Descriptors are pointer aligned, so that the section is an array of them. */
+#define TEST_DESCRIPTOR_ATTRIBUTES __attribute__((used, section("rp2040_tests"), aligned(sizeof(void *))))
+
+/* Weak: an executable without tests has no section. */
+extern const struct test_descriptor __start_rp2040_tests[] __attribute__((weak));
+extern const struct test_descriptor __stop_rp2040_tests[] __attribute__((weak));
+
+static TaskHandle_t testRunnerHandle = NULL;
+#if RP2040config_USE_STATIC_ALLOCATION
+static StackType_t testRunnerStack[RP2040config_tskMASTER_STACK_SIZE];
+static StaticTask_t testRunnerTcb;
+#endif
+
+struct test_runner_params{
+    uint32_t mode;
+    const char *filter;
+};
+
+static struct test_runner_params test_runner_params;
+
+/* Task blocked in wait_test_runner, and whether the runner has finished. */
+static TaskHandle_t testRunnerWaiter = NULL;
+static bool test_runner_done = false;
+
+/*
+    Called by the master of a test before exiting.
+*/
+
+static inline void test_finished(struct test_state *state){
+    state->finished = timing_now();
+    state->running = false;
+    if(testRunnerHandle != NULL){
+        xTaskNotifyGive(testRunnerHandle);
+    }
+}
+
+/*
+    True if name matches one of the comma separated patterns of filter.
+*/
+
+static inline bool test_selected(const char *name, const char *filter){
+    if(filter == NULL || filter[0] == '\0'){
+        return true;
+    }
+    size_t name_length = strlen(name);
+    while(*filter != '\0'){
+        size_t length = strcspn(filter, ",");
+        bool prefix = length > 0 && filter[length-1] == '*';
+        size_t compared = prefix ? length-1 : length;
+        if((prefix ? name_length >= compared : name_length == compared) &&
+           strncmp(name, filter, compared) == 0){
+            return true;
+        }
+        filter += length;
+        if(*filter == ','){
+            filter++;
+        }
+    }
+    return false;
+}
+
+/*
+    Batch of the test: the tests with the same batch are run together.
+*/
+
+static inline uint32_t test_batch(uint32_t mode, const struct test_descriptor *test){
+    switch(mode){
+        case TEST_RUN_PARALLEL:
+            return 0;
+        case TEST_RUN_GROUPS:
+            return test->state->group;
+        default:
+            return (uint32_t) (test - __start_rp2040_tests);
+    }
+}
+
+/*
+    True if the test is selected by the filter and belongs to the batch.
+*/
+
+static inline bool test_in_batch(const struct test_runner_params *params, const struct test_descriptor *test, uint32_t batch){
+    return test_selected(test->name, params->filter) && test_batch(params->mode, test) == batch;
+}
+
+static void vTestRunnerFunction(void *pvParameters){
+    const struct test_runner_params *params = (const struct test_runner_params *) pvParameters;
+    const struct test_descriptor *test;
+    uint32_t n_tests = 0;
+    uint32_t batch = 0;
+    bool first = true;
+
+    timing_calibrate();
+    timing_stamp_t runner_start = timing_now();
+    while(true){
+        /* Smallest batch not run yet. */
+        bool found = false;
+        uint32_t next = UINT32_MAX;
+        for(test = __start_rp2040_tests; test < __stop_rp2040_tests; ++test){
+            uint32_t id = test_batch(params->mode, test);
+            if(test_selected(test->name, params->filter) && (first || id > batch) && id <= next){
+                next = id;
+                found = true;
+            }
+        }
+        if(!found){
+            break;
+        }
+        uint32_t started = 0;
+        for(test = __start_rp2040_tests; test < __stop_rp2040_tests; ++test){
+            if(test_in_batch(params, test, next)){
+                test->state->running = true;
+                test->state->started = timing_now();
+                test->start();
+                started++;
+            }
+        }
+        for(uint32_t finished = 0; finished < started; ){
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    /* Some master has exited. */
+            finished = 0;
+            for(test = __start_rp2040_tests; test < __stop_rp2040_tests; ++test){
+                finished += test_in_batch(params, test, next) && !test->state->running;
+            }
+        }
+        for(test = __start_rp2040_tests; test < __stop_rp2040_tests; ++test){
+            if(test_in_batch(params, test, next)){
+                printf("%s> wall_time:\t %llu " RP2040_TIME_UNIT "\n", test->name,
+                    (unsigned long long) timing_raw_diff(test->state->started, test->state->finished));
+            }
+        }
+        n_tests += started;
+        batch = next;
+        first = false;
+        vTaskDelay(1);  /* Let the idle task reclaim the tasks of the batch. */
+    }
+    printf("test_runner> tests:\t %lu \n", (unsigned long) n_tests);
+    printf("test_runner> wall_time:\t %llu " RP2040_TIME_UNIT "\n", (unsigned long long) timing_elapsed(runner_start));
+    testRunnerHandle = NULL;
+    /* Sequentially consistent with wait_test_runner: either it sees done or the runner sees it. */
+    __atomic_store_n(&test_runner_done, true, __ATOMIC_SEQ_CST);
+    TaskHandle_t waiter = __atomic_load_n(&testRunnerWaiter, __ATOMIC_SEQ_CST);
+    if(waiter != NULL){
+        xTaskNotifyGive(waiter);
+    }
+    vTaskDelete(NULL);
+}
+
+/*
+    Blocks the calling task until the runner has run all the selected tests.
+    Only one task can wait for the runner.
+*/
+
+static inline void wait_test_runner(void){
+    __atomic_store_n(&testRunnerWaiter, xTaskGetCurrentTaskHandle(), __ATOMIC_SEQ_CST);
+    while(!__atomic_load_n(&test_runner_done, __ATOMIC_SEQ_CST)){
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/*
+    Creates the task running the registered tests, before the scheduler is started.
+*/
+
+static inline void start_test_runner(uint32_t mode, const char *filter){
+#ifdef RP2040_HOST_BUILD
+    if(getenv("RP2040_TEST_FILTER") != NULL){
+        filter = getenv("RP2040_TEST_FILTER");
+    }
+#endif
+    test_runner_params.mode = mode;
+    test_runner_params.filter = filter;
+#if RP2040config_USE_STATIC_ALLOCATION
+    testRunnerHandle = xTaskCreateStatic(vTestRunnerFunction,
+        "vTestRunnerFunction",
+        RP2040config_tskMASTER_STACK_SIZE,
+        &test_runner_params,
+        RP2040config_tskMASTER_PRIORITY,
+        testRunnerStack,
+        &testRunnerTcb);
+#else
+    xTaskCreate(vTestRunnerFunction,
+        "vTestRunnerFunction",
+        RP2040config_tskMASTER_STACK_SIZE,
+        &test_runner_params,
+        RP2040config_tskMASTER_PRIORITY,
+        &testRunnerHandle);
+#endif
+}
+
+#endif
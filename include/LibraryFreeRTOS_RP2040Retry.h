@@ -0,0 +1,76 @@
+/*
+
+Retry policy of create_multicore_function_validator, applied when the cores disagree.
+
+A run is attempted at most max_attempts times (0 means until the cores agree). Before every
+new attempt the master sleeps for a backoff doubling at each attempt, from backoff_ticks up to
+backoff_max_ticks, so that a persistent fault does not keep the cores busy at full power.
+When the attempts are exhausted the escalation callback (if any) is called and the run is
+given up as failed.
+
+The policy of every test starts from the RP2040config_RETRY_* defaults and can be changed
+with configure_retry(test_name, ...) before the master is started.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_RETRY_H
+#define LIBRARY_FREE_RTOS_RP2040_RETRY_H
+
+#include "FreeRTOS.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef void (*retry_escalation_t)(const char *test_name, uint32_t run, uint32_t attempts);
+
+struct retry_policy{
+    uint32_t max_attempts;
+    TickType_t backoff_ticks;
+    TickType_t backoff_max_ticks;
+    retry_escalation_t escalation;
+};
+
+struct retry_stats{
+    uint32_t retries;           /* Attempts after the first one, over all the runs. */
+    uint32_t failed_runs;       /* Runs given up after max_attempts. */
+    uint64_t wasted_time;       /* Time of the attempts where the cores disagreed. */
+    TickType_t backoff_ticks;   /* Time slept between the attempts. */
+};
+
+#define RETRY_POLICY_DEFAULT {                                                                       \
+    RP2040config_RETRY_MAX_ATTEMPTS,                                                                 \
+    RP2040config_RETRY_BACKOFF_TICKS,                                                                \
+    RP2040config_RETRY_BACKOFF_MAX_TICKS,                                                            \
+    NULL                                                                                             \
+}
+
+static inline bool retry_exhausted(const struct retry_policy *policy, uint32_t attempts){
+    return policy->max_attempts != 0 && attempts >= policy->max_attempts;
+}
+
+/*
+    Ticks to wait before the attempt following the given number of failed attempts.
+*/
+
+static inline TickType_t retry_backoff(const struct retry_policy *policy, uint32_t attempts){
+    TickType_t backoff = policy->backoff_ticks;
+    for(uint32_t i=1; i<attempts && backoff < policy->backoff_max_ticks; ++i){
+        backoff *= 2;
+    }
+    return backoff < policy->backoff_max_ticks ? backoff : policy->backoff_max_ticks;
+}
+
+static inline void retry_stats_init(struct retry_stats *stats){
+    stats->retries = 0;
+    stats->failed_runs = 0;
+    stats->wasted_time = 0;
+    stats->backoff_ticks = 0;
+}
+
+#endif
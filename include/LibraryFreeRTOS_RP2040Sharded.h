@@ -0,0 +1,69 @@
+/*
+
+Sharded accumulator: one slot per core, merged when it is read.
+
+Instead of every core updating the same shared variable (and serializing on a lock), each core
+adds to its own slot, and the value of the accumulator is the sum of the slots. A slot is written
+only by the tasks of its core, so no lock nor atomic read-modify-write is needed, and the two
+cores never touch the same word (the slots are RP2040config_SHARD_ALIGN aligned).
+
+The slot is selected with get_core_num(), so it must be updated only by tasks pinned to a core,
+as the slaves of the validators. It must be merged when no core is updating it (e.g. by the
+master after the slaves have finished).
+
+    create_sharded_accumulator(counter, int32_t)
+
+    sharded_reset(counter, 0);
+    sharded_add(counter, 1);            // On every core.
+    int32_t total = sharded_merge(counter);
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_SHARDED_H
+#define LIBRARY_FREE_RTOS_RP2040_SHARDED_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "pico/platform.h"
+
+/*
+    Declares the accumulator name, holding values of type type.
+*/
+#define create_sharded_accumulator(name, type)                                                       \
+static struct{                                                                                       \
+    type value __attribute__((aligned(RP2040config_SHARD_ALIGN)));                                   \
+} name[RP2040config_testRUN_ON_CORES];                                                               \
+
+/*
+    Slot of the calling core, usable as an lvalue.
+*/
+#define sharded_slot(name) (name[get_core_num()].value)
+
+#define sharded_add(name, delta) (sharded_slot(name) += (delta))
+
+/*
+    Sets the value of the accumulator: the first slot takes the value, the others 0.
+*/
+#define sharded_reset(name, initial_value)                                                           \
+for(int shard_i=0; shard_i<RP2040config_testRUN_ON_CORES; ++shard_i){                                \
+    name[shard_i].value = shard_i == 0 ? (initial_value) : 0;                                        \
+}                                                                                                    \
+
+/*
+    Value of the accumulator, the sum of all the slots.
+*/
+#define sharded_merge(name)                                                                          \
+({                                                                                                   \
+    __typeof__(name[0].value) shard_sum = 0;                                                         \
+    for(int shard_i=0; shard_i<RP2040config_testRUN_ON_CORES; ++shard_i){                            \
+        shard_sum += name[shard_i].value;                                                            \
+    }                                                                                                \
+    shard_sum;                                                                                       \
+})
+
+#endif
@@ -0,0 +1,103 @@
+/*
+
+Stack sizes of the tasks of the validators, and report of how much of them is used.
+
+Every validator records the high-water mark (uxTaskGetStackHighWaterMark, the minimum free space
+ever left) of its master and of its slaves, and prints at the end the words used out of the
+words allocated:
+
+    test_name> stack_master:\t 112/256 words
+    test_name> stack_slave_0:\t 74/256 words
+
+With RP2040config_STACK_CALIBRATION the validators also print, for every test, a line such as
+
+    #define RP2040_STACK_test_name ~, 144, 106
+
+holding the stack of the master and of the slaves (used + RP2040config_STACK_MARGIN words).
+Collected in LibraryFreeRTOS_RP2040Stacks.h, anywhere in the include path of the test, e.g.
+
+    grep '^#define RP2040_STACK_' output.txt > TestOperations/LibraryFreeRTOS_RP2040Stacks.h
+
+these lines replace RP2040config_tskMASTER_STACK_SIZE and RP2040config_tskSLAVE_STACK_SIZE
+for the tests they name (STACK_MASTER_SIZE, STACK_SLAVE_SIZE); the other tests keep the defaults.
+
+On the host the tasks run on the stacks of their threads, not on the ones given to the kernel,
+whose high-water marks never move: the report only says so, and nothing is calibrated.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_STACK_H
+#define LIBRARY_FREE_RTOS_RP2040_STACK_H
+
+#include "FreeRTOS.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__has_include)
+#if __has_include("LibraryFreeRTOS_RP2040Stacks.h")
+#include "LibraryFreeRTOS_RP2040Stacks.h"
+#endif
+#endif
+
+/*
+    RP2040_STACK_<test_name>, if defined, expands to "~, master, slave": the size is the second
+    (third) argument after it, which is the default when the name is not a macro.
+*/
+#define STACK_MASTER_SIZE(test_name) STACK_ARG2(RP2040_STACK_##test_name, RP2040config_tskMASTER_STACK_SIZE, ~)
+#define STACK_SLAVE_SIZE(test_name) STACK_ARG3(RP2040_STACK_##test_name, ~, RP2040config_tskSLAVE_STACK_SIZE, ~)
+#define STACK_ARG2(...) STACK_ARG2_EXPANDED(__VA_ARGS__)
+#define STACK_ARG2_EXPANDED(a, b, ...) b
+#define STACK_ARG3(...) STACK_ARG3_EXPANDED(__VA_ARGS__)
+#define STACK_ARG3_EXPANDED(a, b, c, ...) c
+
+#define STACK_FREE_UNKNOWN ((UBaseType_t) -1)
+
+static inline UBaseType_t stack_free_min(UBaseType_t a, UBaseType_t b){
+    return a < b ? a : b;
+}
+
+/*
+    Prints the stack used by the master and by the n_slaves slaves (the replicas of the NMR validator)
+    of a test, given their high-water marks. Slaves which never ran are skipped.
+*/
+
+static inline void stack_report(const char *test_name, uint32_t master_size, UBaseType_t master_free,
+                                uint32_t slave_size, const UBaseType_t *slave_free, uint32_t n_slaves){
+#ifdef RP2040_HOST_BUILD
+    (void) master_size;
+    (void) master_free;
+    (void) slave_size;
+    (void) slave_free;
+    (void) n_slaves;
+    printf("%s> stack:\t not measured on the host\n", test_name);
+#else
+    uint32_t slave_used = 0;
+    uint32_t master_used = master_size > master_free ? master_size - (uint32_t) master_free : 0;
+    printf("%s> stack_master:\t %lu/%lu words\n", test_name, (unsigned long) master_used, (unsigned long) master_size);
+    for(uint32_t i=0; i<n_slaves; ++i){
+        if(slave_free[i] == STACK_FREE_UNKNOWN){
+            continue;
+        }
+        uint32_t used = slave_size > slave_free[i] ? slave_size - (uint32_t) slave_free[i] : 0;
+        if(used > slave_used){
+            slave_used = used;
+        }
+        printf("%s> stack_slave_%lu:\t %lu/%lu words\n", test_name,
+            (unsigned long) i, (unsigned long) used, (unsigned long) slave_size);
+    }
+#if RP2040config_STACK_CALIBRATION
+    printf("#define RP2040_STACK_%s ~, %lu, %lu\n", test_name,
+        (unsigned long) (master_used + RP2040config_STACK_MARGIN),
+        (unsigned long) (slave_used + RP2040config_STACK_MARGIN));
+#endif
+#endif
+}
+
+#endif
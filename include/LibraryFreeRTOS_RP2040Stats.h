@@ -0,0 +1,205 @@
+/*
+
+Streaming statistics of the times measured by the validators.
+
+Every sample updates, in constant memory:
+
+- min, max, mean and standard deviation (Welford's algorithm);
+- median and 99th percentile, estimated with the P-square algorithm
+  (R. Jain, I. Chlamtac, "The P2 algorithm for dynamic calculation of quantiles
+  and histograms without storing observations", CACM 1985), which keeps 5 markers
+  per quantile regardless of the number of samples.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_STATS_H
+#define LIBRARY_FREE_RTOS_RP2040_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct p2_quantile{
+    double p;               /* Quantile estimated, in (0,1). */
+    uint32_t n;             /* Samples seen. */
+    double q[5];            /* Marker heights (the estimate is q[2]). */
+    double pos[5];          /* Actual marker positions. */
+    double desired[5];      /* Desired marker positions. */
+    double increment[5];    /* Increment of the desired positions at every sample. */
+};
+
+struct run_stats{
+    uint32_t count;
+    uint64_t min;
+    uint64_t max;
+    double mean;
+    double m2;              /* Sum of the squared distances from the mean. */
+    struct p2_quantile median;
+    struct p2_quantile p99;
+};
+
+static inline void p2_init(struct p2_quantile *quantile, double p){
+    quantile->p = p;
+    quantile->n = 0;
+    quantile->increment[0] = 0;
+    quantile->increment[1] = p/2;
+    quantile->increment[2] = p;
+    quantile->increment[3] = (1+p)/2;
+    quantile->increment[4] = 1;
+}
+
+static inline void p2_add(struct p2_quantile *quantile, double x){
+    double *q = quantile->q;
+    double *pos = quantile->pos;
+    int k;
+
+    if(quantile->n < 5){
+        /* Keep the first samples sorted, they initialize the markers. */
+        int i = quantile->n++;
+        while(i > 0 && q[i-1] > x){
+            q[i] = q[i-1];
+            i--;
+        }
+        q[i] = x;
+        if(quantile->n == 5){
+            double p = quantile->p;
+            for(int j=0; j<5; ++j){
+                pos[j] = j+1;
+            }
+            quantile->desired[0] = 1;
+            quantile->desired[1] = 1+2*p;
+            quantile->desired[2] = 1+4*p;
+            quantile->desired[3] = 3+2*p;
+            quantile->desired[4] = 5;
+        }
+        return;
+    }
+    quantile->n++;
+
+    /* Find the cell of the sample, extending the extremes if needed. */
+    if(x < q[0]){
+        q[0] = x;
+        k = 0;
+    } else if(x >= q[4]){
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while(k < 3 && x >= q[k+1]){
+            k++;
+        }
+    }
+    for(int i=k+1; i<5; ++i){
+        pos[i]++;
+    }
+    for(int i=0; i<5; ++i){
+        quantile->desired[i] += quantile->increment[i];
+    }
+
+    /* Move the middle markers towards their desired positions. */
+    for(int i=1; i<4; ++i){
+        double d = quantile->desired[i] - pos[i];
+        if((d >= 1 && pos[i+1] - pos[i] > 1) || (d <= -1 && pos[i-1] - pos[i] < -1)){
+            double s = d > 0 ? 1 : -1;
+            double parabolic = q[i] + s/(pos[i+1] - pos[i-1]) *
+                ((pos[i] - pos[i-1] + s)*(q[i+1] - q[i])/(pos[i+1] - pos[i]) +
+                 (pos[i+1] - pos[i] - s)*(q[i] - q[i-1])/(pos[i] - pos[i-1]));
+            if(q[i-1] < parabolic && parabolic < q[i+1]){
+                q[i] = parabolic;
+            } else {
+                int j = i + (int) s;
+                q[i] = q[i] + s*(q[j] - q[i])/(pos[j] - pos[i]);
+            }
+            pos[i] += s;
+        }
+    }
+}
+
+static inline double p2_value(struct p2_quantile *quantile){
+    if(quantile->n == 0){
+        return 0;
+    }
+    if(quantile->n < 5){
+        /* Few samples: they are still stored sorted. */
+        return quantile->q[(uint32_t) (quantile->p*(quantile->n-1) + 0.5)];
+    }
+    return quantile->q[2];
+}
+
+static inline void run_stats_init(struct run_stats *stats){
+    stats->count = 0;
+    stats->min = UINT64_MAX;
+    stats->max = 0;
+    stats->mean = 0;
+    stats->m2 = 0;
+    p2_init(&stats->median, 0.5);
+    p2_init(&stats->p99, 0.99);
+}
+
+static inline void run_stats_add(struct run_stats *stats, uint64_t sample){
+    double x = (double) sample;
+    double delta = x - stats->mean;
+    stats->count++;
+    stats->mean += delta/stats->count;
+    stats->m2 += delta*(x - stats->mean);
+    if(sample < stats->min){
+        stats->min = sample;
+    }
+    if(sample > stats->max){
+        stats->max = sample;
+    }
+    p2_add(&stats->median, x);
+    p2_add(&stats->p99, x);
+}
+
+/*
+    Square root by Newton's method, so that the library does not need libm.
+*/
+
+static inline double stats_sqrt(double x){
+    if(x <= 0){
+        return 0;
+    }
+    double r = x > 1 ? x/2 : 1;
+    for(int i=0; i<64; ++i){
+        double next = (r + x/r)/2;
+        if(next == r){
+            break;
+        }
+        r = next;
+    }
+    return r;
+}
+
+static inline double run_stats_stddev(struct run_stats *stats){
+    return stats->count > 1 ? stats_sqrt(stats->m2/(stats->count - 1)) : 0;
+}
+
+/*
+    Prints one line with all the statistics of a core:
+    <test_name>> time_core_<core>:  n=.. min=.. median=.. mean=.. p99=.. max=.. stddev=.. <unit>
+*/
+
+static inline void run_stats_print(const char *test_name, int core, struct run_stats *stats, const char *unit){
+    if(stats->count == 0){
+        printf("%s> time_core_%d:\t n=0\n", test_name, core);
+        return;
+    }
+    printf("%s> time_core_%d:\t n=%lu min=%llu median=%llu mean=%llu p99=%llu max=%llu stddev=%llu %s\n",
+        test_name, core,
+        (unsigned long) stats->count,
+        (unsigned long long) stats->min,
+        (unsigned long long) (p2_value(&stats->median) + 0.5),
+        (unsigned long long) (stats->mean + 0.5),
+        (unsigned long long) (p2_value(&stats->p99) + 0.5),
+        (unsigned long long) stats->max,
+        (unsigned long long) (run_stats_stddev(stats) + 0.5),
+        unit);
+}
+
+#endif
@@ -0,0 +1,384 @@
+/*
+
+Binary telemetry of the results produced by the validators.
+
+When RP2040config_USE_TELEMETRY is set, the masters do not print their results with printf:
+each result becomes a small binary record, written in a lock-free ring owned by the master
+(single producer) and drained by a low-priority task (single consumer), which sends the bytes
+to the serial port on the RP2040 or to a file (or named pipe) on the host.
+
+Frame format (integers are little-endian):
+
+    +------+-----+------+-------------------+----------+
+    | 0xA5 | len | type | payload (len B)   | crc16    |
+    +------+-----+------+-------------------+----------+
+
+The CRC is the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of len, type and payload,
+so a reader can resynchronize on the next 0xA5 after a corrupted frame or a line of text.
+
+Records:
+
+- TELEMETRY_RECORD_NAME     : test_id (u16), name of the test (len-2 chars, not terminated).
+- TELEMETRY_RECORD_RESULT   : test_id (u16), core (u8), kind<<4 | size (u8), iteration (u32),
+                              value (u64, the first size bytes of the value), time (u64, RP2040_TIME_UNIT).
+- TELEMETRY_RECORD_DROPPED  : test_id (u16), number of records lost because the ring was full (u32).
+
+The records can be decoded with "python clientSerial.py --decode <file>".
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_TELEMETRY_H
+#define LIBRARY_FREE_RTOS_RP2040_TELEMETRY_H
+
+#include "FreeRTOS.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "task.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef RP2040_HOST_BUILD
+#include <stdlib.h>
+#endif
+
+#if (RP2040config_TELEMETRY_RING_SIZE & (RP2040config_TELEMETRY_RING_SIZE - 1)) != 0
+#error "RP2040config_TELEMETRY_RING_SIZE must be a power of two"
+#endif
+
+#define TELEMETRY_SYNC              0xA5
+#define TELEMETRY_FRAME_OVERHEAD    5       /* sync, len, type and crc16. */
+
+#define TELEMETRY_RECORD_NAME       0x01
+#define TELEMETRY_RECORD_RESULT     0x02
+#define TELEMETRY_RECORD_DROPPED    0x03
+
+/*
+    Kind of the value of a result record, to let the decoder interpret its bytes.
+*/
+
+#define TELEMETRY_KIND_UNSIGNED     0
+#define TELEMETRY_KIND_SIGNED       1
+#define TELEMETRY_KIND_FLOAT        2
+
+#define TELEMETRY_KIND(value)                                                   \
+    _Generic((value),                                                           \
+        float: TELEMETRY_KIND_FLOAT,                                            \
+        double: TELEMETRY_KIND_FLOAT,                                           \
+        signed char: TELEMETRY_KIND_SIGNED,                                     \
+        short: TELEMETRY_KIND_SIGNED,                                           \
+        int: TELEMETRY_KIND_SIGNED,                                             \
+        long: TELEMETRY_KIND_SIGNED,                                            \
+        long long: TELEMETRY_KIND_SIGNED,                                       \
+        default: TELEMETRY_KIND_UNSIGNED)                                       \
+
+struct telemetry_ring{
+    uint8_t buffer[RP2040config_TELEMETRY_RING_SIZE];
+    uint32_t head;          /* Bytes written (by the master only). */
+    uint32_t tail;          /* Bytes drained (by the drain task only). */
+    uint32_t dropped;       /* Records not written because the ring was full (by the master only). */
+    uint16_t test_id;
+    bool disabled;          /* Not registered: nothing is written nor drained. */
+};
+
+/*
+    Rings registered by the masters, drained in order by the drain task.
+    A ring is written in telemetry_rings before telemetry_ring_count is increased (release),
+    so the drain task only reads the rings registered completely.
+*/
+
+static struct telemetry_ring *telemetry_rings[RP2040config_TELEMETRY_MAX_TESTS];
+static uint32_t telemetry_ring_count = 0;
+static TaskHandle_t telemetryDrainHandle = NULL;
+#if RP2040config_USE_STATIC_ALLOCATION
+static StackType_t telemetryDrainStack[RP2040config_tskTELEMETRY_STACK_SIZE];
+static StaticTask_t telemetryDrainTcb;
+#endif
+#ifdef RP2040_HOST_BUILD
+static FILE *telemetry_file = NULL;
+static const char *telemetry_path = NULL;
+#endif
+
+static inline uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, size_t size){
+    for(size_t i=0; i<size; ++i){
+        crc ^= (uint16_t) data[i] << 8;
+        for(int bit=0; bit<8; ++bit){
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static inline void telemetry_put_le(uint8_t *dst, uint64_t value, size_t size){
+    for(size_t i=0; i<size; ++i){
+        dst[i] = (uint8_t) (value >> (8*i));
+    }
+}
+
+/*
+    Copies size bytes in the ring starting from the absolute position pos (it may wrap).
+*/
+
+static inline void telemetry_ring_copy(struct telemetry_ring *ring, uint32_t pos, const uint8_t *data, size_t size){
+    for(size_t i=0; i<size; ++i){
+        ring->buffer[(pos + i) & (RP2040config_TELEMETRY_RING_SIZE - 1)] = data[i];
+    }
+}
+
+/*
+    Frames the payload in the ring at the absolute position head, without publishing it.
+    Returns the position following the frame.
+*/
+
+static inline uint32_t telemetry_put_frame(struct telemetry_ring *ring, uint32_t head, uint8_t type, const uint8_t *payload, uint8_t size){
+    uint8_t header[3] = { TELEMETRY_SYNC, size, type };
+    uint8_t crc[2];
+    telemetry_put_le(crc, telemetry_crc16(telemetry_crc16(0xFFFF, header + 1, 2), payload, size), 2);
+    telemetry_ring_copy(ring, head, header, sizeof(header));
+    telemetry_ring_copy(ring, head + sizeof(header), payload, size);
+    telemetry_ring_copy(ring, head + sizeof(header) + size, crc, sizeof(crc));
+    return head + size + TELEMETRY_FRAME_OVERHEAD;
+}
+
+/*
+    Producer side: frames the payload and appends it to the ring.
+
+    If the frame does not fit, the master waits for the drain task, unless
+    RP2040config_TELEMETRY_DROP_WHEN_FULL is set: then it never blocks, the frame is dropped and counted,
+    and the count is written as a TELEMETRY_RECORD_DROPPED record as soon as there is room
+    (before the frame, so the records keep their order).
+*/
+
+static inline bool telemetry_write_frame(struct telemetry_ring *ring, uint8_t type, const uint8_t *payload, uint8_t size){
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t room = RP2040config_TELEMETRY_RING_SIZE - (head - tail);
+    uint32_t needed = size + TELEMETRY_FRAME_OVERHEAD;
+    uint32_t dropped = ring->dropped;
+
+    if(ring->disabled){
+        return false;
+    }
+    if(dropped != 0){
+        needed += 6 + TELEMETRY_FRAME_OVERHEAD;
+    }
+#if RP2040config_TELEMETRY_DROP_WHEN_FULL
+    if(needed > room){
+        __atomic_store_n(&ring->dropped, dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+#else
+    while(needed > room){
+        if(telemetryDrainHandle != NULL){
+            xTaskNotifyGive(telemetryDrainHandle);
+        }
+        vTaskDelay(RP2040config_TELEMETRY_DRAIN_PERIOD);
+        room = RP2040config_TELEMETRY_RING_SIZE - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    }
+#endif
+    if(dropped != 0){
+        uint8_t lost[6];
+        telemetry_put_le(lost, ring->test_id, 2);
+        telemetry_put_le(lost + 2, dropped, 4);
+        head = telemetry_put_frame(ring, head, TELEMETRY_RECORD_DROPPED, lost, sizeof(lost));
+    }
+    head = telemetry_put_frame(ring, head, type, payload, size);
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    if(room >= RP2040config_TELEMETRY_RING_SIZE/2 && room - needed < RP2040config_TELEMETRY_RING_SIZE/2 &&
+       telemetryDrainHandle != NULL){
+        xTaskNotifyGive(telemetryDrainHandle);  /* Half full: do not wait for the drain period. */
+    }
+    if(dropped != 0){
+        /* After head: whoever sees no drop pending also sees the record of the drops. */
+        __atomic_store_n(&ring->dropped, 0, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+/*
+    Producer side: writes the count of the records dropped, if any, waiting for room in the ring.
+    It is called by the masters when they have finished.
+*/
+
+static inline void telemetry_flush_dropped(struct telemetry_ring *ring){
+    while(!ring->disabled && ring->dropped != 0){
+        uint32_t dropped = ring->dropped;
+        uint32_t room = RP2040config_TELEMETRY_RING_SIZE -
+            (ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+        if(room < 6 + TELEMETRY_FRAME_OVERHEAD){
+            vTaskDelay(RP2040config_TELEMETRY_DRAIN_PERIOD);
+            continue;
+        }
+        uint8_t lost[6];
+        telemetry_put_le(lost, ring->test_id, 2);
+        telemetry_put_le(lost + 2, dropped, 4);
+        __atomic_store_n(&ring->head, telemetry_put_frame(ring, ring->head, TELEMETRY_RECORD_DROPPED, lost, sizeof(lost)),
+            __ATOMIC_RELEASE);
+        __atomic_store_n(&ring->dropped, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+    Producer side: writes a result record. Only the first 8 bytes of the value are kept.
+*/
+
+static inline bool telemetry_emit_result(struct telemetry_ring *ring, uint32_t iteration, uint8_t core,
+                                         uint8_t kind, const void *value, size_t value_size, uint64_t time){
+    uint8_t payload[24] = {0};
+    if(value_size > 8){
+        value_size = 8;
+    }
+    telemetry_put_le(payload, ring->test_id, 2);
+    payload[2] = core;
+    payload[3] = (uint8_t) (kind << 4 | value_size);
+    telemetry_put_le(payload + 4, iteration, 4);
+    memcpy(payload + 8, value, value_size);  /* The RP2040 and the hosts supported are little-endian. */
+    telemetry_put_le(payload + 16, time, 8);
+    return telemetry_write_frame(ring, TELEMETRY_RECORD_RESULT, payload, sizeof(payload));
+}
+
+/*
+    Sends the drained bytes out: to the serial port (without CR/LF translation) on the RP2040,
+    to the telemetry file on the host.
+*/
+
+static inline void telemetry_output(const uint8_t *data, size_t size){
+#ifdef RP2040_HOST_BUILD
+    fwrite(data, 1, size, telemetry_file);
+#else
+    for(size_t i=0; i<size; ++i){
+        putchar_raw(data[i]);
+    }
+#endif
+}
+
+/*
+    Consumer side: sends out everything written in the ring so far. Returns the number of bytes.
+*/
+
+static inline uint32_t telemetry_drain(struct telemetry_ring *ring){
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = ring->tail;
+    uint32_t drained = head - tail;
+    while(tail != head){
+        uint32_t offset = tail & (RP2040config_TELEMETRY_RING_SIZE - 1);
+        uint32_t chunk = head - tail;
+        if(chunk > RP2040config_TELEMETRY_RING_SIZE - offset){
+            chunk = RP2040config_TELEMETRY_RING_SIZE - offset;
+        }
+        telemetry_output(ring->buffer + offset, chunk);
+        tail += chunk;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    return drained;
+}
+
+/*
+    Registers the ring of a test and writes the record which associates its id to its name.
+    It is called by the master itself before its first record, since the master is the only
+    producer of the ring; the masters running together register under a critical section.
+    Beyond RP2040config_TELEMETRY_MAX_TESTS the ring is disabled, since the drain task would never
+    empty it: the master prints its results instead (see REPORT_SLAVE_RESULT), its other records are lost.
+*/
+
+static inline void telemetry_register(struct telemetry_ring *ring, const char *name){
+    uint8_t payload[2 + 32];
+    size_t length = strlen(name);
+    bool registered = false;
+    taskENTER_CRITICAL();
+    if(telemetry_ring_count < RP2040config_TELEMETRY_MAX_TESTS){
+        ring->test_id = (uint16_t) telemetry_ring_count;
+        telemetry_rings[telemetry_ring_count] = ring;
+        __atomic_store_n(&telemetry_ring_count, telemetry_ring_count + 1, __ATOMIC_RELEASE);
+        registered = true;
+    }
+    taskEXIT_CRITICAL();
+    ring->disabled = !registered;
+    if(!registered){
+        printf("telemetry: too many tests, %s printed instead, increase RP2040config_TELEMETRY_MAX_TESTS\n", name);
+        return;
+    }
+    if(length > sizeof(payload) - 2){
+        length = sizeof(payload) - 2;
+    }
+    telemetry_put_le(payload, ring->test_id, 2);
+    memcpy(payload + 2, name, length);
+    telemetry_write_frame(ring, TELEMETRY_RECORD_NAME, payload, (uint8_t) (length + 2));
+}
+
+/*
+    Blocks the caller until the drain task has sent out everything written in the ring,
+    including the count of the records dropped.
+*/
+
+static inline void telemetry_wait_drained(struct telemetry_ring *ring){
+    while(!ring->disabled && (__atomic_load_n(&ring->dropped, __ATOMIC_ACQUIRE) != 0 ||
+          __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))){
+        vTaskDelay(RP2040config_TELEMETRY_DRAIN_PERIOD);
+    }
+}
+
+static void vTelemetryDrainFunction(void *pvParameters){
+    (void) pvParameters;
+    while(true){
+        uint32_t drained = 0;
+        uint32_t count = __atomic_load_n(&telemetry_ring_count, __ATOMIC_ACQUIRE);
+        for(uint32_t i=0; i<count; ++i){
+            drained += telemetry_drain(telemetry_rings[i]);
+        }
+        if(drained != 0){
+#ifdef RP2040_HOST_BUILD
+            fflush(telemetry_file);
+#else
+            stdio_flush();
+#endif
+        } else {
+            ulTaskNotifyTake(pdTRUE, RP2040config_TELEMETRY_DRAIN_PERIOD);
+        }
+    }
+}
+
+/*
+    Creates the drain task. It is called by start_FreeRTOS.
+
+    On the host the records are written to the file (or named pipe) given by the
+    RP2040_TELEMETRY_PATH environment variable, RP2040config_TELEMETRY_PATH otherwise ("-" is stdout).
+*/
+
+static inline void telemetry_start(){
+#ifdef RP2040_HOST_BUILD
+    telemetry_path = getenv("RP2040_TELEMETRY_PATH");
+    if(telemetry_path == NULL){
+        telemetry_path = RP2040config_TELEMETRY_PATH;
+    }
+    telemetry_file = strcmp(telemetry_path, "-") == 0 ? stdout : fopen(telemetry_path, "wb");
+    if(telemetry_file == NULL){
+        printf("telemetry: cannot open %s, writing to stdout\n", telemetry_path);
+        telemetry_file = stdout;
+    }
+#endif
+#if RP2040config_USE_STATIC_ALLOCATION
+    telemetryDrainHandle = xTaskCreateStatic(vTelemetryDrainFunction,
+        "vTelemetryDrainFunction",
+        RP2040config_tskTELEMETRY_STACK_SIZE,
+        NULL,
+        RP2040config_tskTELEMETRY_PRIORITY,
+        telemetryDrainStack,
+        &telemetryDrainTcb);
+#else
+    xTaskCreate(vTelemetryDrainFunction,
+        "vTelemetryDrainFunction",
+        RP2040config_tskTELEMETRY_STACK_SIZE,
+        NULL,
+        RP2040config_tskTELEMETRY_PRIORITY,
+        &telemetryDrainHandle);
+#endif
+}
+
+#endif
@@ -0,0 +1,173 @@
+/*
+
+Timing backends used by save_time_now() and calc_time_diff().
+
+The backend is selected with RP2040config_TIMING_BACKEND in LibraryFreeRTOS_RP2040Config.h:
+
+- RP2040_TIMING_SYSTICK         : processor cycles, read from the SysTick current value register of the
+                                  core. The register wraps every RTOS tick, the number of wraps is
+                                  recovered from the microsecond timer read together with it.
+                                  The SysTick of the two cores are not in phase: the cycles are only
+                                  exact for measurements which start and end on the same core. When
+                                  the cores differ (a task which is not pinned may migrate), the
+                                  measurement falls back to the microsecond timer, converted to cycles.
+- RP2040_TIMING_US_TIMER        : microseconds, from the 64-bit timer of the RP2040 (get_absolute_time()).
+- RP2040_TIMING_MONOTONIC_RAW   : nanoseconds, from clock_gettime(CLOCK_MONOTONIC_RAW) (host builds only).
+
+The cost of taking the two timestamps is measured by timing_calibrate() and subtracted
+from every measurement. timing_to_ns() converts a measurement to nanoseconds.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_TIMING_H
+#define LIBRARY_FREE_RTOS_RP2040_TIMING_H
+
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#if RP2040config_TIMING_BACKEND == RP2040_TIMING_SYSTICK
+#include "hardware/timer.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "pico/platform.h"
+#elif RP2040config_TIMING_BACKEND == RP2040_TIMING_US_TIMER
+#include "hardware/timer.h"
+#elif RP2040config_TIMING_BACKEND == RP2040_TIMING_MONOTONIC_RAW
+#include <time.h>
+#else
+#error "Unknown RP2040config_TIMING_BACKEND"
+#endif
+
+/*
+    Number of empty measurements used to calibrate the overhead (the minimum is kept).
+*/
+
+#define TIMING_CALIBRATION_RUNS 64
+
+#if RP2040config_TIMING_BACKEND == RP2040_TIMING_SYSTICK
+
+#define RP2040_TIME_UNIT "cycles"
+
+typedef struct{
+    uint64_t us;        /* Coarse time, used to count the wraps of SysTick. */
+    uint32_t cvr;       /* SysTick current value (it counts down). */
+    uint32_t core;      /* Core whose SysTick was read. */
+} timing_stamp_t;
+
+static inline timing_stamp_t timing_now(){
+    timing_stamp_t stamp;
+    do{                 /* Read again if the task migrated while reading. */
+        stamp.core = get_core_num();
+        stamp.us = time_us_64();
+        stamp.cvr = systick_hw->cvr;
+    } while(stamp.core != get_core_num());
+    return stamp;
+}
+
+static inline uint64_t timing_raw_diff(timing_stamp_t start, timing_stamp_t end){
+    uint32_t period = systick_hw->rvr + 1;
+    uint64_t cycles_per_us = clock_get_hz(clk_sys) / 1000000u;
+    uint64_t approx = (end.us - start.us) * cycles_per_us;
+    if(period <= 1){
+        return approx;      /* SysTick not running (scheduler not started yet). */
+    }
+    if(start.core != end.core){
+        return approx;      /* Different SysTick, only the microsecond timer is shared. */
+    }
+    uint32_t partial = (start.cvr >= end.cvr) ? start.cvr - end.cvr : start.cvr + period - end.cvr;
+    /* The microsecond timer is precise to a few hundred cycles, far less than a period. */
+    uint64_t wraps = (approx > partial) ? (approx - partial + period/2) / period : 0;
+    return wraps*period + partial;
+}
+
+/* Divided first: cycles * 10^9 would overflow after about 147 s at 125 MHz. */
+static inline uint64_t timing_to_ns(uint64_t cycles){
+    uint64_t hz = clock_get_hz(clk_sys);
+    return cycles / hz * 1000000000ull + cycles % hz * 1000000000ull / hz;
+}
+
+#elif RP2040config_TIMING_BACKEND == RP2040_TIMING_US_TIMER
+
+#define RP2040_TIME_UNIT "us"
+
+typedef absolute_time_t timing_stamp_t;
+
+static inline timing_stamp_t timing_now(){
+    return get_absolute_time();
+}
+
+static inline uint64_t timing_raw_diff(timing_stamp_t start, timing_stamp_t end){
+    return absolute_time_diff_us(start, end);
+}
+
+static inline uint64_t timing_to_ns(uint64_t us){
+    return us * 1000u;
+}
+
+#else
+
+#define RP2040_TIME_UNIT "ns"
+
+typedef struct timespec timing_stamp_t;
+
+static inline timing_stamp_t timing_now(){
+    timing_stamp_t stamp;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &stamp);
+    return stamp;
+}
+
+static inline uint64_t timing_raw_diff(timing_stamp_t start, timing_stamp_t end){
+    return (uint64_t) ((int64_t) (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec));
+}
+
+static inline uint64_t timing_to_ns(uint64_t ns){
+    return ns;
+}
+
+#endif
+
+/*
+    Overhead of an empty measurement, in RP2040_TIME_UNIT.
+*/
+
+static uint64_t timing_overhead = 0;
+static bool timing_calibrated = false;
+
+/*
+    Measures the overhead of save_time_now()/calc_time_diff() around nothing.
+    It is called by the masters before their first dispatch (the first call only does the work).
+*/
+
+static inline void timing_calibrate(){
+    if(timing_calibrated){
+        return;
+    }
+    uint64_t overhead = UINT64_MAX;
+    for(int i=0; i<TIMING_CALIBRATION_RUNS; ++i){
+        timing_stamp_t start = timing_now();
+        uint64_t measured = timing_raw_diff(start, timing_now());
+        if(measured < overhead){
+            overhead = measured;
+        }
+    }
+    timing_overhead = overhead;
+    timing_calibrated = true;
+}
+
+/*
+    Time elapsed since start, without the calibrated overhead.
+*/
+
+static inline uint64_t timing_elapsed(timing_stamp_t start){
+    uint64_t measured = timing_raw_diff(start, timing_now());
+    return measured > timing_overhead ? measured - timing_overhead : 0;
+}
+
+#endif
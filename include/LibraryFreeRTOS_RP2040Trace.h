@@ -0,0 +1,50 @@
+/*
+
+Trace macros of the kernel, included at the end of FreeRTOSConfig.h.
+
+They forward the scheduler events to the profiler (see LibraryFreeRTOS_RP2040Profiler.h).
+The hooks are weak, so that an executable without the profiler links and only pays a test
+for each event: on the host the kernel is built once for all the tests, and is always traced.
+
+The macros are variadic because the kernels differ in the arguments they pass (the index of
+the notification since V11); the task notified is always pxTCB in the kernel functions.
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_TRACE_H
+#define LIBRARY_FREE_RTOS_RP2040_TRACE_H
+
+extern void profiler_trace_create(void *task) __attribute__((weak));
+extern void profiler_trace_delete(void *task) __attribute__((weak));
+extern void profiler_trace_switched_out(void) __attribute__((weak));
+extern void profiler_trace_switched_in(void) __attribute__((weak));
+extern void profiler_trace_block(void) __attribute__((weak));
+extern void profiler_trace_notify(void *task) __attribute__((weak));
+
+#define PROFILER_TRACE(hook, ...)                                                           \
+    do{                                                                                     \
+        if(hook){                                                                           \
+            hook(__VA_ARGS__);                                                              \
+        }                                                                                   \
+    }while(0)
+
+#define traceTASK_CREATE(pxNewTCB)          PROFILER_TRACE(profiler_trace_create, (void *) (pxNewTCB))
+#define traceTASK_DELETE(pxTaskToDelete)    PROFILER_TRACE(profiler_trace_delete, (void *) (pxTaskToDelete))
+#define traceTASK_SWITCHED_OUT()            PROFILER_TRACE(profiler_trace_switched_out)
+#define traceTASK_SWITCHED_IN()             PROFILER_TRACE(profiler_trace_switched_in)
+
+/* The running task blocks waiting for a notification. */
+#define traceTASK_NOTIFY_TAKE_BLOCK(...)    PROFILER_TRACE(profiler_trace_block)
+#define traceTASK_NOTIFY_WAIT_BLOCK(...)    PROFILER_TRACE(profiler_trace_block)
+
+#define traceTASK_NOTIFY(...)               PROFILER_TRACE(profiler_trace_notify, (void *) pxTCB)
+#define traceTASK_NOTIFY_FROM_ISR(...)      PROFILER_TRACE(profiler_trace_notify, (void *) pxTCB)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(...) PROFILER_TRACE(profiler_trace_notify, (void *) pxTCB)
+
+#endif
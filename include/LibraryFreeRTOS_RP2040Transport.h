@@ -0,0 +1,171 @@
+/*
+
+Signals from one task to another (the doorbell between the master and its slaves), with
+interchangeable backends selected by RP2040config_TRANSPORT:
+
+- RP2040_TRANSPORT_NOTIFY   : a task notification per signal (xTaskNotifyGive / ulTaskNotifyTake).
+                              Every signal takes the kernel lock, and wakes the receiver through
+                              the scheduler (a cross-core yield if it runs on the other core).
+- RP2040_TRANSPORT_FIFO     : a lock-free single-producer/single-consumer FIFO of signals. The
+                              receiver polls it RP2040config_TRANSPORT_SPIN times before blocking
+                              on its notification, and the sender notifies only a receiver which
+                              has blocked, so a receiver running on the other core is signalled
+                              without the kernel.
+
+The mailbox FIFOs of the SIO would be the natural doorbell, but the SMP port of FreeRTOS owns them
+(they carry its cross-core yields, and its interrupt handler drains them), so the FIFO backend keeps
+its signals in memory, as on the host: like the broadcast channel (LibraryFreeRTOS_RP2040Broadcast.h)
+it needs only aligned 32-bit loads and stores, each word written by one side only.
+
+A transport has one sender and one receiver. Transports to the same receiver share its notification:
+with RP2040_TRANSPORT_NOTIFY the signals are counted there, so it can wait on them in any order.
+The doorbell behind the FIFO backend is also rung by the completion barrier
+(see LibraryFreeRTOS_RP2040Barrier.h).
+
+Authors:
+
+- Matteo Briscini
+- Matteo Cenzato
+- Michele Adorni
+
+*/
+
+#ifndef LIBRARY_FREE_RTOS_RP2040_TRANSPORT_H
+#define LIBRARY_FREE_RTOS_RP2040_TRANSPORT_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LibraryFreeRTOS_RP2040Config.h"
+#include "pico/platform.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_NOTIFY
+#define TRANSPORT_NAME "notify"
+#elif RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+#define TRANSPORT_NAME "fifo"
+#else
+#error "Unknown RP2040config_TRANSPORT"
+#endif
+
+/*
+    Doorbell rung by one task and answered by another, without the kernel while the receiver is
+    awake: the rings are counted in memory, and the receiver is notified only once it has blocked.
+*/
+
+struct doorbell{
+    TaskHandle_t receiver;
+    uint32_t rung;          /* Written by the sender only. */
+    uint32_t answered;      /* Written by the receiver only. */
+    uint32_t sleeping;      /* The receiver blocks on its notification (written by the receiver only). */
+    uint32_t blocks;        /* Times the receiver has blocked. */
+};
+
+static inline void doorbell_init(struct doorbell *bell, TaskHandle_t receiver){
+    bell->receiver = receiver;
+    bell->rung = 0;
+    bell->answered = 0;
+    bell->sleeping = 0;
+    bell->blocks = 0;
+}
+
+static inline void doorbell_ring(struct doorbell *bell){
+    /* Sequentially consistent with the receiver going to sleep: either it sees the ring,
+       or the sender sees it sleeping. */
+    __atomic_store_n(&bell->rung, bell->rung + 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&bell->sleeping, __ATOMIC_SEQ_CST)){
+        xTaskNotifyGive(bell->receiver);
+    }
+}
+
+static inline bool doorbell_answer(struct doorbell *bell){
+    if(__atomic_load_n(&bell->rung, __ATOMIC_ACQUIRE) == bell->answered){
+        return false;
+    }
+    bell->answered++;
+    return true;
+}
+
+/*
+    Answers one ring, polling the doorbell spin times before blocking.
+*/
+
+static inline void doorbell_wait(struct doorbell *bell, uint32_t spin){
+    for(uint32_t i=0; i<spin; ++i){
+        if(doorbell_answer(bell)){
+            return;
+        }
+#ifdef RP2040_HOST_BUILD
+        taskYIELD();    /* The POSIX port runs one task at a time: let the sender run. */
+#else
+        tight_loop_contents();
+#endif
+    }
+    while(!doorbell_answer(bell)){
+        __atomic_store_n(&bell->sleeping, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&bell->rung, __ATOMIC_SEQ_CST) == bell->answered){
+            bell->blocks++;
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    /* Only a wake-up: the rings are counted in rung. */
+        }
+        __atomic_store_n(&bell->sleeping, 0, __ATOMIC_RELAXED);
+    }
+}
+
+struct transport{
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    struct doorbell fifo;
+#else
+    TaskHandle_t receiver;
+#endif
+};
+
+/*
+    Initializes the transport to receiver, before it is used by either side.
+*/
+
+static inline void transport_init(struct transport *transport, TaskHandle_t receiver){
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    doorbell_init(&transport->fifo, receiver);
+#else
+    transport->receiver = receiver;
+#endif
+}
+
+/*
+    Binds the transport to its receiver, created after transport_init.
+*/
+
+static inline void transport_bind(struct transport *transport, TaskHandle_t receiver){
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    transport->fifo.receiver = receiver;
+#else
+    transport->receiver = receiver;
+#endif
+}
+
+/*
+    Sender side: posts one signal. The memory written before it is visible to the receiver
+    once it has consumed the signal.
+*/
+
+static inline void transport_signal(struct transport *transport){
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    doorbell_ring(&transport->fifo);
+#else
+    xTaskNotifyGive(transport->receiver);
+#endif
+}
+
+/*
+    Receiver side: consumes one signal, blocking until it is posted.
+*/
+
+static inline void transport_wait(struct transport *transport){
+#if RP2040config_TRANSPORT == RP2040_TRANSPORT_FIFO
+    doorbell_wait(&transport->fifo, RP2040config_TRANSPORT_SPIN);
+#else
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+#endif
+}
+
+#endif
@@ -0,0 +1,85 @@
+import argparse
+import collections
+import os
+import re
+import subprocess
+import sys
+
+# RAM of each test registered in an executable, from the symbols of the linked binary.
+#
+# A test is found through its masterTaskHandle_<test_name>, and every variable whose name ends
+# with _<test_name> (static locals included) is charged to it. With
+# RP2040config_USE_STATIC_ALLOCATION this includes the stacks and the TCBs of its tasks
+# (*_storage_<test_name> and the storage of its worker pool), so the report is the whole RAM
+# of the test. Everything else (the FreeRTOS heap, the kernel, the SDK) is reported as shared.
+
+RAM_TYPES = set("bBdDsSgG")
+LOCAL_SUFFIX = re.compile(r"\.(lto_priv\.)?\d+$")
+MASTER_PREFIX = "masterTaskHandle_"
+TASK_STORAGE = re.compile(r"(^|_)storage_|^worker_pool_")
+HEAP_SYMBOLS = {"ucHeap"}
+
+
+def read_symbols(nm, binary):
+    """Yields (name, size) of the variables in RAM."""
+    output = subprocess.run([nm, "-S", "-t", "d", binary],
+                            check=True, capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) != 4 or fields[2] not in RAM_TYPES:
+            continue
+        yield LOCAL_SUFFIX.sub("", fields[3]), int(fields[1])
+
+
+def owner(name, tests):
+    """Longest test name the variable ends with, None if shared."""
+    for test in tests:
+        if name == MASTER_PREFIX + test or name.endswith("_" + test):
+            return test
+    return None
+
+
+def report(nm, binary, out):
+    symbols = list(read_symbols(nm, binary))
+    tests = sorted((name[len(MASTER_PREFIX):] for name, _ in symbols if name.startswith(MASTER_PREFIX)),
+                   key=len, reverse=True)
+    total = collections.Counter()
+    tasks = collections.Counter()
+    shared = heap = 0
+    for name, size in symbols:
+        test = owner(name, tests)
+        if test is None:
+            if name in HEAP_SYMBOLS:
+                heap += size
+            else:
+                shared += size
+            continue
+        total[test] += size
+        if TASK_STORAGE.search(name):
+            tasks[test] += size
+
+    out.write("%s\n" % os.path.basename(binary))
+    out.write("  %-40s %10s %10s\n" % ("test", "ram", "tasks"))
+    for test in sorted(tests):
+        out.write("  %-40s %10d %10d\n" % (test, total[test], tasks[test]))
+    out.write("  %-40s %10d\n" % ("(shared)", shared))
+    out.write("  %-40s %10d\n" % ("(freertos heap)", heap))
+    out.write("  %-40s %10d\n\n" % ("(total)", sum(total.values()) + shared + heap))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Report the RAM used by each test registered in the binaries.")
+    parser.add_argument("binaries", nargs="+", help="linked executables (ELF)")
+    parser.add_argument("--nm", default="nm", help="nm of the toolchain (arm-none-eabi-nm for the board)")
+    parser.add_argument("-o", "--output", help="file written with the report (stdout by default)")
+    args = parser.parse_args()
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    for binary in args.binaries:
+        report(args.nm, binary, out)
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()